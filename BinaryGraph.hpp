@@ -0,0 +1,321 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__BINARYGRAPH_HPP_
+#define INC_3COLORING__BINARYGRAPH_HPP_
+
+#include "Graph.hpp"
+#include "GraphIO.hpp"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+// On-disk layout (little-endian, every section 8-byte aligned):
+//   BinaryGraphHeader
+//   offsets      uint64[n + 1]
+//   neighbours   uint64[num_arcs]
+//   core         uint8[n]   vertexes left after peeling degree <= 2, if kHasCore
+//   components   uint64[n]  connected component id per vertex, if kHasComponents
+//   degree_order uint64[n]  vertexes by non-increasing degree, if kHasDegreeOrder
+struct BinaryGraphHeader {
+  static constexpr char kMagic[8] = {'3', 'C', 'O', 'L', 'C', 'S', 'R', '\0'};
+  static constexpr uint32_t kVersion = 1;
+  static constexpr uint32_t kByteOrder = 0x01020304;
+
+  static constexpr uint32_t kHasCore = 1;
+  static constexpr uint32_t kHasComponents = 2;
+  static constexpr uint32_t kHasDegreeOrder = 4;
+
+  char magic[8] = {};
+  uint32_t version = kVersion;
+  uint32_t byte_order = kByteOrder;
+  uint32_t flags = 0;
+  uint32_t reserved = 0;
+  uint64_t n = 0;
+  uint64_t num_arcs = 0;
+  uint64_t offsets_at = 0;
+  uint64_t neighbours_at = 0;
+  uint64_t core_at = 0;
+  uint64_t components_at = 0;
+  uint64_t degree_order_at = 0;
+};
+static_assert(sizeof(Vertex) == sizeof(uint64_t) && sizeof(size_t) == sizeof(uint64_t),
+              "Binary graph arrays are mapped as Vertex/size_t directly");
+
+// Precomputed data stored next to the CSR arrays.
+struct GraphExtras {
+  std::vector<uint8_t> core;
+  std::vector<uint64_t> components;
+  std::vector<uint64_t> degree_order;
+
+  static GraphExtras compute(GraphView graph) {
+    GraphExtras extras;
+
+    // peeling of degree <= 2 vertexes, same rule as ColoringSolver::drop_2_deg_vertexes_
+    extras.core.assign(graph.n, 1);
+    std::vector<size_t> degree(graph.n);
+    std::vector<Vertex> stack;
+    for (Vertex v = 0; v < graph.n; ++v) {
+      degree[v] = graph.degree(v);
+      if (degree[v] <= 2) {
+        extras.core[v] = 0;
+        stack.push_back(v);
+      }
+    }
+    while (!stack.empty()) {
+      Vertex v = stack.back();
+      stack.pop_back();
+      for (auto u: graph.adjacent(v)) {
+        if (extras.core[u] && --degree[u] <= 2) {
+          extras.core[u] = 0;
+          stack.push_back(u);
+        }
+      }
+    }
+
+    extras.components.assign(graph.n, graph.n);
+    uint64_t component = 0;
+    for (Vertex vertex = 0; vertex < graph.n; ++vertex) {
+      if (extras.components[vertex] != graph.n) {
+        continue;
+      }
+      extras.components[vertex] = component;
+      stack.assign(1, vertex);
+      while (!stack.empty()) {
+        Vertex v = stack.back();
+        stack.pop_back();
+        for (auto u: graph.adjacent(v)) {
+          if (extras.components[u] == graph.n) {
+            extras.components[u] = component;
+            stack.push_back(u);
+          }
+        }
+      }
+      ++component;
+    }
+
+    // counting sort by degree
+    size_t max_degree = 0;
+    for (Vertex v = 0; v < graph.n; ++v) {
+      max_degree = std::max(max_degree, graph.degree(v));
+    }
+    std::vector<size_t> starts(max_degree + 2, 0);
+    for (Vertex v = 0; v < graph.n; ++v) {
+      ++starts[max_degree - graph.degree(v) + 1];
+    }
+    for (size_t d = 0; d <= max_degree; ++d) {
+      starts[d + 1] += starts[d];
+    }
+    extras.degree_order.resize(graph.n);
+    for (Vertex v = 0; v < graph.n; ++v) {
+      extras.degree_order[starts[max_degree - graph.degree(v)]++] = v;
+    }
+
+    return extras;
+  }
+};
+
+class BinaryGraphWriter {
+ public:
+  static void write(const std::string& path, GraphView graph, bool with_extras = true) {
+    GraphExtras extras;
+    if (with_extras) {
+      extras = GraphExtras::compute(graph);
+    }
+
+    BinaryGraphHeader header;
+    std::memcpy(header.magic, BinaryGraphHeader::kMagic, sizeof(header.magic));
+    header.n = graph.n;
+    header.num_arcs = graph.num_arcs();
+
+    uint64_t at = aligned_(sizeof(BinaryGraphHeader));
+    header.offsets_at = at;
+    at = aligned_(at + (graph.n + 1) * sizeof(uint64_t));
+    header.neighbours_at = at;
+    at = aligned_(at + graph.num_arcs() * sizeof(uint64_t));
+    if (with_extras) {
+      header.flags = BinaryGraphHeader::kHasCore | BinaryGraphHeader::kHasComponents |
+                     BinaryGraphHeader::kHasDegreeOrder;
+      header.core_at = at;
+      at = aligned_(at + graph.n);
+      header.components_at = at;
+      at = aligned_(at + graph.n * sizeof(uint64_t));
+      header.degree_order_at = at;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      throw std::runtime_error("Can't create file " + path);
+    }
+
+    write_(file, &header, sizeof(header));
+    write_section_(file, header.offsets_at, graph.offsets.data(), graph.offsets.size_bytes());
+    write_section_(file, header.neighbours_at, graph.neighbours.data(), graph.neighbours.size_bytes());
+    if (with_extras) {
+      write_section_(file, header.core_at, extras.core.data(), extras.core.size());
+      write_section_(file, header.components_at, extras.components.data(),
+                     extras.components.size() * sizeof(uint64_t));
+      write_section_(file, header.degree_order_at, extras.degree_order.data(),
+                     extras.degree_order.size() * sizeof(uint64_t));
+    }
+
+    if (!file) {
+      throw std::runtime_error("Can't write file " + path);
+    }
+  }
+
+ private:
+  static uint64_t aligned_(uint64_t at) {
+    return (at + 7) / 8 * 8;
+  }
+
+  static void write_(std::ofstream& file, const void* data, size_t size) {
+    file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+  }
+
+  static void write_section_(std::ofstream& file, uint64_t at, const void* data, size_t size) {
+    static constexpr char kPadding[8] = {};
+    write_(file, kPadding, at - static_cast<uint64_t>(file.tellp()));
+    write_(file, data, size);
+  }
+};
+
+// Binary graph solved in place: all arrays point into the mapping.
+class MappedGraph {
+ public:
+  static std::shared_ptr<const MappedGraph> open(const std::string& path) {
+    return std::shared_ptr<const MappedGraph>(new MappedGraph(MappedFile(path), path));
+  }
+
+  GraphView view() const {
+    return {header_->n, array_<size_t>(header_->offsets_at, header_->n + 1),
+            array_<Vertex>(header_->neighbours_at, header_->num_arcs)};
+  }
+
+  bool has(uint32_t flag) const {
+    return (header_->flags & flag) != 0;
+  }
+  std::span<const uint8_t> core() const {
+    return has(BinaryGraphHeader::kHasCore) ? array_<uint8_t>(header_->core_at, header_->n)
+                                            : std::span<const uint8_t>();
+  }
+  std::span<const uint64_t> components() const {
+    return has(BinaryGraphHeader::kHasComponents) ? array_<uint64_t>(header_->components_at, header_->n)
+                                                  : std::span<const uint64_t>();
+  }
+  std::span<const uint64_t> degree_order() const {
+    return has(BinaryGraphHeader::kHasDegreeOrder) ? array_<uint64_t>(header_->degree_order_at, header_->n)
+                                                   : std::span<const uint64_t>();
+  }
+
+ private:
+  MappedGraph(MappedFile file, const std::string& path): file_(std::move(file)) {
+    if (file_.size() < sizeof(BinaryGraphHeader)) {
+      throw std::runtime_error("File " + path + " is too small for a binary graph");
+    }
+    header_ = reinterpret_cast<const BinaryGraphHeader*>(file_.data());
+
+    if (std::memcmp(header_->magic, BinaryGraphHeader::kMagic, sizeof(header_->magic)) != 0) {
+      throw std::runtime_error("File " + path + " is not a binary graph");
+    }
+    if (header_->version != BinaryGraphHeader::kVersion) {
+      throw std::runtime_error("Unsupported binary graph version " + std::to_string(header_->version));
+    }
+    if (header_->byte_order != BinaryGraphHeader::kByteOrder) {
+      throw std::runtime_error("Binary graph " + path + " has foreign byte order");
+    }
+
+    uint64_t n = header_->n;
+    if (n == UINT64_MAX) {
+      throw std::runtime_error("Binary graph " + path + " is truncated or corrupted");
+    }
+    check_section_(header_->offsets_at, n + 1, sizeof(uint64_t), path);
+    check_section_(header_->neighbours_at, header_->num_arcs, sizeof(uint64_t), path);
+    if (has(BinaryGraphHeader::kHasCore)) {
+      check_section_(header_->core_at, n, 1, path);
+    }
+    if (has(BinaryGraphHeader::kHasComponents)) {
+      check_section_(header_->components_at, n, sizeof(uint64_t), path);
+    }
+    if (has(BinaryGraphHeader::kHasDegreeOrder)) {
+      check_section_(header_->degree_order_at, n, sizeof(uint64_t), path);
+    }
+
+    // the solver indexes by these values without checks, so a file is read in full once here
+    GraphView graph = view();
+    if (!graph.is_valid()) {
+      throw std::runtime_error("Binary graph " + path + " has inconsistent offsets or neighbours");
+    }
+    for (auto component: components()) {
+      if (component >= n) {
+        throw std::runtime_error("Binary graph " + path + " has a component id out of range");
+      }
+    }
+    auto order = degree_order();
+    std::vector<bool> seen(order.size(), false);
+    for (size_t i = 0; i < order.size(); ++i) {
+      if (order[i] >= n || seen[order[i]] || (i > 0 && graph.degree(order[i - 1]) < graph.degree(order[i]))) {
+        throw std::runtime_error("Binary graph " + path + " has a degree order that is not one");
+      }
+      seen[order[i]] = true;
+    }
+  }
+
+  // count items of item_size bytes at offset at, all inside the file; the size can't overflow
+  void check_section_(uint64_t at, uint64_t count, uint64_t item_size, const std::string& path) const {
+    if (at % 8 != 0 || at > file_.size() || count > (file_.size() - at) / item_size) {
+      throw std::runtime_error("Binary graph " + path + " is truncated or corrupted");
+    }
+  }
+
+  template<class T>
+  std::span<const T> array_(uint64_t at, uint64_t size) const {
+    return {reinterpret_cast<const T*>(file_.data() + at), size};
+  }
+
+  MappedFile file_;
+  const BinaryGraphHeader* header_ = nullptr;
+};
+
+// graph6 (one graph per line), see https://users.cecs.anu.edu.au/~bdm/data/formats.txt
+inline Graph read_graph6(std::string_view line) {
+  auto byte = [&](size_t i) -> uint64_t {
+    if (i >= line.size() || line[i] < 63 || line[i] > 126) {
+      throw std::runtime_error("Malformed graph6 line");
+    }
+    return static_cast<uint64_t>(line[i] - 63);
+  };
+
+  size_t n = 0, pos = 0;
+  if (!line.empty() && line[0] == '>') {
+    pos = line.find("<<") + 2;  // optional ">>graph6<<" header
+  }
+  if (byte(pos) < 63) {
+    n = byte(pos++);
+  } else if (byte(pos + 1) < 63) {
+    n = (byte(pos + 1) << 12) | (byte(pos + 2) << 6) | byte(pos + 3);
+    pos += 4;
+  } else {
+    for (size_t i = 2; i < 8; ++i) {
+      n = (n << 6) | byte(pos + i);
+    }
+    pos += 8;
+  }
+
+  std::vector<std::pair<Vertex, Vertex>> edges;
+  size_t bit = 0;
+  for (Vertex j = 1; j < n; ++j) {
+    for (Vertex i = 0; i < j; ++i, ++bit) {
+      if ((byte(pos + bit / 6) >> (5 - bit % 6)) & 1) {
+        edges.emplace_back(i, j);
+      }
+    }
+  }
+
+  std::sort(edges.begin(), edges.end());
+  return Graph::from_sorted_edges(n, edges);
+}
+
+#endif //INC_3COLORING__BINARYGRAPH_HPP_
@@ -0,0 +1,202 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__CHECKPOINT_HPP_
+#define INC_3COLORING__CHECKPOINT_HPP_
+
+#include "Graph.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct CheckpointOptions {
+  std::string path;
+  std::chrono::seconds interval{60};
+
+  // $COLORING_CHECKPOINT (path, no checkpoints without it), $COLORING_CHECKPOINT_INTERVAL (seconds).
+  // Limitation: the branch path inside the SSS<3, 2> search of a seed tree leaf is not saved, a
+  // resumed run repeats the leaf that was running from its start. A leaf whose search outlasts
+  // every run never finishes, however often it is resumed.
+  static std::optional<CheckpointOptions> from_env() {
+    const char* path = std::getenv("COLORING_CHECKPOINT");
+    if (path == nullptr) {
+      return std::nullopt;
+    }
+
+    CheckpointOptions options;
+    options.path = path;
+    if (const char* interval = std::getenv("COLORING_CHECKPOINT_INTERVAL")) {
+      options.interval = std::chrono::seconds(std::stoull(interval));
+    }
+    return options;
+  }
+};
+
+// Frontier of solve(): the witnesses of the components already solved and, for the component in
+// progress, the colors of the active branch of its seed tree. The seed tree is explored depth
+// first with colors in increasing order, so every branch left of the active one is complete; a
+// resumed search restarts each level at the recorded color and nothing completed is explored
+// again. The unit of progress is a seed tree leaf: the SSS<3, 2> search of the leaf that was
+// running is repeated, its own recursion is not saved (see CheckpointOptions::from_env).
+//
+// File, text:
+//   3coloring-checkpoint <fingerprint of the graph>
+//   solved <count>, then per component "<id> <size>" and size lines "v color"
+//   active <id> <depth> <colors of the branch...>
+class Checkpointer {
+ public:
+  static constexpr char kMagic[] = "3coloring-checkpoint";
+
+  // Resumes from options.path when it holds a checkpoint of the same graph; a checkpoint of
+  // another graph throws.
+  Checkpointer(CheckpointOptions options, GraphView graph):
+      options_(std::move(options)), fingerprint_(graph.fingerprint()), last_save_(Clock::now()) {
+    load_();
+  }
+
+  // Witness of a component finished before the checkpoint, by the smallest vertex of the component.
+  const Coloring* solved(Vertex component) const {
+    auto it = solved_.find(component);
+    return it != solved_.end() ? &it->second : nullptr;
+  }
+
+  void begin_component(Vertex component) {
+    active_ = component;
+    path_.clear();
+    resuming_ = resume_component_ == component && !resume_path_.empty();
+  }
+
+  void finish_component(Vertex component, const Coloring* coloring) {
+    if (coloring != nullptr) {
+      solved_[component] = *coloring;
+    }
+    active_.reset();
+    path_.clear();
+    maybe_save_();
+  }
+
+  // First color to try at a level of the seed tree: the recorded one on the resumed branch.
+  Color first_color(size_t level) const {
+    return resuming_ && level < resume_path_.size() ? resume_path_[level] : 0;
+  }
+
+  // The search takes color at level; every smaller color of the level is complete.
+  void enter(size_t level, Color color) {
+    if (resuming_ && level < resume_path_.size() && color != resume_path_[level]) {
+      resuming_ = false;
+    }
+    path_.resize(level);
+    path_.push_back(color);
+    maybe_save_();
+  }
+
+  // Called once the whole solve is over: the checkpoint is of no further use.
+  void finish() {
+    std::remove(options_.path.c_str());
+  }
+
+  void save() const {
+    std::string temporary = options_.path + ".tmp";
+    {
+      std::ofstream file(temporary, std::ios::trunc);
+      if (!file) {
+        throw std::runtime_error("Can't create file " + temporary);
+      }
+      file << kMagic << " " << fingerprint_ << "\n";
+      file << "solved " << solved_.size() << "\n";
+      for (auto& [component, coloring]: solved_) {
+        file << component << " " << coloring.size() << "\n";
+        for (auto [v, color]: coloring) {
+          file << v << " " << color << "\n";
+        }
+      }
+      if (active_) {
+        file << "active " << *active_ << " " << path_.size();
+        for (auto color: path_) {
+          file << " " << color;
+        }
+        file << "\n";
+      }
+      if (!file.flush()) {
+        throw std::runtime_error("Can't write file " + temporary);
+      }
+    }
+    // the old checkpoint stays valid until the new one is complete
+    if (std::rename(temporary.c_str(), options_.path.c_str()) != 0) {
+      throw std::runtime_error("Can't replace checkpoint " + options_.path);
+    }
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  void maybe_save_() {
+    auto now = Clock::now();
+    if (now - last_save_ >= options_.interval) {
+      save();
+      last_save_ = now;
+    }
+  }
+
+  void load_() {
+    std::ifstream file(options_.path);
+    if (!file) {
+      return;
+    }
+
+    std::string magic, word;
+    uint64_t fingerprint = 0;
+    size_t count = 0;
+    if (!(file >> magic >> fingerprint >> word >> count) || magic != kMagic || word != "solved") {
+      throw std::runtime_error("File " + options_.path + " is not a checkpoint");
+    }
+    if (fingerprint != fingerprint_) {
+      throw std::runtime_error("Checkpoint " + options_.path + " belongs to another graph");
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      Vertex component;
+      size_t size;
+      file >> component >> size;
+      auto& coloring = solved_[component];
+      for (size_t j = 0; j < size; ++j) {
+        Vertex v;
+        Color color;
+        file >> v >> color;
+        coloring.insert(coloring.end(), {v, color});
+      }
+    }
+
+    size_t depth = 0;
+    if (file >> word && word == "active" && file >> resume_component_ >> depth) {
+      resume_path_.resize(depth);
+      for (auto& color: resume_path_) {
+        file >> color;
+      }
+    }
+    if (file.bad() || (!file.eof() && file.fail())) {
+      throw std::runtime_error("Checkpoint " + options_.path + " is malformed");
+    }
+  }
+
+  CheckpointOptions options_;
+  uint64_t fingerprint_;
+  Clock::time_point last_save_;
+
+  std::map<Vertex, Coloring> solved_;
+  std::optional<Vertex> active_;
+  std::vector<Color> path_;
+
+  Vertex resume_component_ = 0;
+  std::vector<Color> resume_path_;
+  bool resuming_ = false;
+};
+
+#endif //INC_3COLORING__CHECKPOINT_HPP_
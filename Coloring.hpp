@@ -6,7 +6,21 @@
 #define INC_3COLORING__COLORING_HPP_
 
 #include "SSS.hpp"
-#include <queue>
+#include "Graph.hpp"
+#include "BinaryGraph.hpp"
+#include "Propagation.hpp"
+#include "Tabu.hpp"
+#include "Components.hpp"
+#include "TreeDecomposition.hpp"
+#include "Enumeration.hpp"
+#include "ComponentCache.hpp"
+#include "VertexOrder.hpp"
+#include "Checkpoint.hpp"
+#include "Nogood.hpp"
+#include "FastPaths.hpp"
+#include <memory>
+#include <optional>
+#include <unordered_map>
 
 struct Tree{
   Vertex root;
@@ -17,24 +31,37 @@ struct Tree{
   }
 };
 using Forest = std::set<Tree>;
-using Coloring = std::map<Vertex, Color>;
 using Edges = std::map<Vertex, std::set<Vertex>>;
 
+// Cheap graph statistics, taken after degree <= 2 peeling, that drive the choice of engine.
+struct GraphFeatures {
+  size_t n = 0;
+  size_t m = 0;
+  size_t max_degree = 0;
+  double density = 0;
+  size_t core_size = 0;   // vertexes left after drop_2_deg_vertexes_()
+  size_t seeds = 0;       // k, number of vertexes colored by brute force in solve()
+  size_t width = 0;       // min-fill treewidth estimate, above TreeDecompositionSolver::kMaxWidth means "wide"
+};
+
 class ColoringSolver {
  public:
   void add_vertex(Vertex vertex) {
     vertexes_.insert(vertex);
+    components_.add_vertex(vertex);
   }
 
   void create_vertexes(size_t n) {
     for (Vertex v = 0; v < n; ++v) {
-      vertexes_.insert(v);
+      add_vertex(v);
     }
   }
 
   void add_edge(Vertex v1, Vertex v2) {
-    edges_[v1].insert(v2);
-    edges_[v2].insert(v1);
+    if (edges_[v1].insert(v2).second) {
+      edges_[v2].insert(v1);
+      components_.add_edge(v1, v2, edges_[v1].size(), edges_[v2].size());
+    }
   }
 
   void add_edge(Vertex v1, std::set<Vertex> vertexes) {
@@ -54,80 +81,303 @@ class ColoringSolver {
     }
   }
 
+  // TabuSearch with these options runs before the exact search in solve().
+  void set_tabu(const TabuOptions& options) {
+    tabu_ = options;
+  }
+
+  // Local search only: a coloring of the whole graph, or nullopt if none was found in the budget.
+  std::optional<Coloring> tabu_solve(const TabuOptions& options = {}) const {
+    if (graph_) {
+      auto coloring = TabuSearch(*graph_, options).run();
+      if (coloring) {
+        *coloring = original_labels_of_(std::move(*coloring));
+      }
+      return coloring;
+    }
+
+    Vertex n = vertexes_.empty() ? 0 : *vertexes_.rbegin() + 1;
+    std::vector<std::pair<Vertex, Vertex>> edges;
+    for (auto& item: edges_) {
+      n = std::max(n, item.first + 1);
+      for (auto v: item.second) {
+        if (item.first <= v) {
+          edges.emplace_back(item.first, v);
+        }
+      }
+    }
+
+    Graph graph = Graph::from_sorted_edges(n, edges);
+    auto coloring = TabuSearch(graph.view(), options).run();
+    if (coloring) {
+      std::erase_if(*coloring, [&](const auto& item) {
+        return !vertexes_.contains(item.first) && !edges_.contains(item.first);
+      });
+      *coloring = original_labels_of_(std::move(*coloring));
+    }
+    return coloring;
+  }
+
   bool solve() {
-    std::set<Vertex> was_in;
+    if (tabu_) {
+      if (auto coloring = tabu_solve(*tabu_)) {
+        coloring_ = std::move(*coloring);
+        return true;
+      }
+    }
 
-    for (auto& vertex: vertexes_) {
-      if (was_in.contains(vertex)) {
-        continue;
+    TraceSpan span("solve");
+    coloring_.clear();
+    bool result = graph_ ? solve_graph_() : solve_edges_graph_();
+    coloring_ = original_labels_of_(std::move(coloring_));
+    if (checkpoint_) {
+      checkpoint_->finish();
+    }
+    return result;
+  }
+
+  // Periodically saves the progress of solve() to options.path and resumes from the checkpoint
+  // found there; call it once the graph is complete. See Checkpointer.
+  void set_checkpoint(const CheckpointOptions& options) {
+    Graph storage;
+    std::vector<Vertex> labels;
+    checkpoint_ = std::make_shared<Checkpointer>(options, graph_view_(storage, labels));
+  }
+
+  // Where solve() looks up and stores the answers of recurring cores, ComponentCache::global() by
+  // default; nullptr solves without a cache.
+  void set_cache(ComponentCache* cache) {
+    cache_ = cache;
+  }
+
+  // Learns nogoods from the failed leaves of the seed tree of solve(), see NogoodStore.
+  void set_nogoods(const NogoodOptions& options) {
+    nogood_options_ = options;
+  }
+  // Totals over the components solved so far.
+  const NogoodStats& nogood_stats() const {
+    return nogood_stats_;
+  }
+
+  // Dynamic programming over a min-fill tree decomposition of the whole graph; falls back to solve()
+  // when the decomposition is wider than TreeDecompositionSolver::kMaxWidth.
+  bool solve_tree_decomposition() {
+    Graph storage;
+    std::vector<Vertex> labels;
+    GraphView graph = graph_view_(storage, labels);
+
+    TreeDecomposition decomposition(graph, TreeDecomposition::Heuristic::kMinFill,
+                                    TreeDecompositionSolver::kMaxWidth);
+    if (!decomposition.complete()) {
+      return solve();
+    }
+
+    coloring_.clear();
+    TreeDecompositionSolver solver(graph, decomposition);
+    if (!solver.run()) {
+      return false;
+    }
+    auto coloring = solver.coloring();
+    for (auto [v, color]: *coloring) {
+      coloring_[labels.empty() ? v : labels[v]] = color;
+    }
+    return true;
+  }
+
+  // Number of 3-colorings, nullopt if it doesn't fit into 64 bits.
+  // Throws if the tree decomposition is wider than TreeDecompositionSolver::kMaxWidth.
+  std::optional<uint64_t> count_colorings() const {
+    Graph storage;
+    std::vector<Vertex> labels;
+    GraphView graph = graph_view_(storage, labels);
+
+    TreeDecomposition decomposition(graph, TreeDecomposition::Heuristic::kMinFill,
+                                    TreeDecompositionSolver::kMaxWidth);
+    TreeDecompositionSolver solver(graph, decomposition);
+    solver.run();
+    return solver.count();
+  }
+
+  // Cubes for cube-and-conquer: colorings of the first `depth` seeds of the seed tree of solve()
+  // that survive propagation, with the same restricted growth of colors. The graph is colorable
+  // exactly when it has a coloring extending one of them; none at all means it is not colorable.
+  // A graph that peeling empties gives one empty cube.
+  std::vector<Coloring> cubes(size_t depth) const {
+    Graph storage;
+    std::vector<Vertex> labels;
+    GraphView graph = graph_view_(storage, labels);
+
+    Edges edges;
+    for (Vertex v = 0; v < graph.n; ++v) {
+      auto adjacent = graph.adjacent(v);
+      if (std::binary_search(adjacent.begin(), adjacent.end(), v)) {
+        return {};
+      }
+      if (!adjacent.empty()) {
+        edges[v].insert(adjacent.begin(), adjacent.end());
       }
+    }
 
-      std::queue<Vertex> queue;
-      queue.push(vertex);
-      Edges edges;
+    ColoringSolver core(edges);
+    core.add_all_colors();
+    core.drop_2_deg_vertexes_();
+    core.make_forest_();
+    auto seeds = core.get_coloring_vertexes_();
+    std::vector<Vertex> order(seeds.begin(), seeds.end());
+    order.resize(std::min(depth, order.size()));
+
+    std::optional<BitPropagator> propagator;
+    if (!core.vertexes_.empty() && core.vertexes_.size() <= BitPropagator::kMaxVertexes) {
+      propagator.emplace(core.edges_);
+    }
 
-      while (!queue.empty()) {
-        Vertex now = queue.front();
-        queue.pop();
+    std::vector<Coloring> cubes;
+    Coloring assignment;
+    auto split = [&](auto& self, size_t level, const BitDomains& domains, size_t used_colors) -> void {
+      if (level == order.size()) {
+        auto& cube = cubes.emplace_back();
+        for (auto [v, color]: assignment) {
+          cube[labels.empty() ? v : labels[v]] = color;
+        }
+        return;
+      }
 
-        for (auto other_v: edges_[now]) {
-          if (!was_in.contains(other_v)) {
-            queue.push(other_v);
-            was_in.insert(other_v);
+      Vertex seed = order[level];
+      for (Color color = 0; color < std::min(used_colors + 1, colors_.size()); ++color) {
+        BitDomains child_domains;
+        if (propagator) {
+          if (!domains.has(propagator->index(seed), color)) {
+            continue;
+          }
+          child_domains = domains;
+          propagator->assign(child_domains, seed, color);
+          if (!propagator->propagate(child_domains)) {
+            continue;
           }
+        } else if (core.has_neighbour_colored_(assignment, seed, color)) {
+          continue;
         }
 
-        edges[now] = edges_[now];
+        assignment[seed] = color;
+        self(self, level + 1, child_domains, std::max(used_colors, color + 1));
+        assignment.erase(seed);
       }
+    };
+    split(split, 0, propagator ? propagator->full_domains() : BitDomains(), 0);
+    return cubes;
+  }
 
-      ColoringSolver connected(edges);
-      if (!connected.solve_connected()) {
-        return false;
-      }
-    }
+  // All 3-colorings one by one, see enumerate_colorings(). The generator shares or copies the graph,
+  // so it may outlive the solver; borrowed arrays must outlive it too.
+  Generator<Coloring> colorings(EnumerationOptions options = {}) const {
+    Graph storage;
+    std::vector<Vertex> labels;
+    GraphView graph = graph_view_(storage, labels);
+    return colorings_(graph, graph_.has_value(), graph_owner_, std::move(storage), std::move(labels), options);
+  }
 
-    return true;
+  const ComponentTracker& components() const {
+    return components_;
   }
 
   bool stupid_solve() {
-    auto v = *vertexes_.begin();
-    if (v == 5) {
-//      std::cout << v << "\n";
+    // copies made on every branch don't need the tracker
+    auto components = std::move(components_);
+    components_ = {};
+    bool result = stupid_solve_();
+    components_ = std::move(components);
+    coloring_ = original_labels_of_(std::move(coloring_));
+    return result;
+  }
+
+  // 4-coloring, or list coloring with lists of up to four colors from {0, 1, 2, 3}, through the
+  // randomized SSS<4, 2>; vertexes without a list may take any of the four colors.
+  bool solve_list_coloring(const std::map<Vertex, std::set<Color>>& lists = {},
+                           const RandomizedOptions& options = {}) {
+    if (graph_) {
+      materialize_edges_();
     }
 
-    if (vertexes_.size() == 1) {
-      if (!allowed_colors_[v].empty()) {
-        coloring_[v] = *allowed_colors_[v].begin();
-        return true;
-      } else {
-        return false;
+    SSS<4, 2> sss;
+    sss.reset_vertexes();
+    sss.add_vertexes(vertexes_);
+    for (auto vertex: vertexes_) {
+      auto it = lists.find(original_labels_.empty() ? vertex : original_labels_[vertex]);
+      if (it == lists.end()) {
+        sss.add_all_colors(vertex);
+        continue;
+      }
+      for (auto color: it->second) {
+        sss.add_color({vertex, color});
       }
     }
 
-    if (allowed_colors_[v].empty()) {
+    for (auto& item: edges_) {
+      for (auto v: item.second) {
+        for (Color color = 0; color < 4; ++color) {
+          if (item.first < v && sss.is_allow_color({v, color}) && sss.is_allow_color({item.first, color})) {
+            sss.add_constraint({{item.first, color}, {v, color}});
+          }
+        }
+      }
+    }
+
+    if (!sss.solve(options)) {
       return false;
     }
 
-    for (auto color: allowed_colors_[v]) {
-      auto copy = *this;
+    coloring_ = original_labels_of_(std::move(sss.coloring));
+    return true;
+  }
 
-      for (auto u: edges_[v]) {
-        copy.drop_allow_color(u, color);
-        if (copy.allowed_colors_[u].empty()) {
-          continue;
+  GraphFeatures features() const {
+    GraphFeatures features;
+    ColoringSolver core;
+
+    if (graph_) {
+      // only the core is copied out of the CSR arrays
+      GraphView graph = *graph_;
+      features.n = graph.n;
+      features.m = graph.num_arcs() / 2;
+      for (Vertex v = 0; v < graph.n; ++v) {
+        features.max_degree = std::max(features.max_degree, graph.degree(v));
+      }
+
+      auto in_core = graph_core_.empty() ? GraphExtras::compute(graph).core
+                                         : std::vector<uint8_t>(graph_core_.begin(), graph_core_.end());
+      for (Vertex v = 0; v < graph.n; ++v) {
+        for (auto u: graph.adjacent(v)) {
+          if (in_core[v] && in_core[u]) {
+            core.edges_[v].insert(u);
+          }
         }
       }
+    } else {
+      features.n = vertexes_.size();
+      for (auto& item: edges_) {
+        features.m += item.second.size();
+        features.max_degree = std::max(features.max_degree, item.second.size());
+      }
+      features.m /= 2;
 
-      copy.drop_vertex(v);
+      core.edges_ = edges_;
+      core.drop_2_deg_vertexes_();
+    }
 
-      if (copy.stupid_solve()) {
-        coloring_ = copy.coloring_;
-        coloring_[v] = color;
-        return true;
-      }
+    if (features.n > 1) {
+      features.density = 2.0 * static_cast<double>(features.m) /
+                         (static_cast<double>(features.n) * static_cast<double>(features.n - 1));
     }
+    features.core_size = core.edges_.size();
+    core.make_forest_();
+    features.seeds = core.get_coloring_vertexes_().size();
 
-    return false;
+    Graph storage;
+    std::vector<Vertex> labels;
+    features.width = TreeDecomposition(graph_view_(storage, labels), TreeDecomposition::Heuristic::kMinFill,
+                                       TreeDecompositionSolver::kMaxWidth).width();
+
+    return features;
   }
 
 //  Coloring get_coloring() {
@@ -163,6 +413,48 @@ class ColoringSolver {
 //  }
   ColoringSolver() = default;
 
+  explicit ColoringSolver(Graph graph) {
+    auto owner = std::make_shared<const Graph>(std::move(graph));
+    graph_ = owner->view();
+    graph_owner_ = std::move(owner);
+  }
+
+  // Borrows the arrays: they must stay alive and unchanged while the solver (or a generator from
+  // colorings()) uses them. Neighbour lists must be sorted and symmetric.
+  explicit ColoringSolver(GraphView graph): graph_(graph) {}
+
+  // Solves against the mapped arrays without copying them.
+  explicit ColoringSolver(std::shared_ptr<const MappedGraph> graph):
+      graph_(graph->view()), graph_core_(graph->core()), graph_owner_(std::move(graph)) {}
+
+  // Renumbers the vertexes so that neighbours get nearby ids, see VertexOrder; call it once the
+  // graph is complete. The solver then owns a renumbered CSR copy and every coloring it returns
+  // is mapped back to the input vertexes. Precomputed data of a mapped graph is dropped.
+  void reorder(VertexOrder order) {
+    if (order == VertexOrder::kInput) {
+      return;
+    }
+
+    Graph storage;
+    std::vector<Vertex> labels;
+    GraphView graph = graph_view_(storage, labels);
+    auto order_labels = vertex_order(graph, order);
+    auto owner = std::make_shared<const Graph>(relabel_graph(graph, order_labels));
+
+    for (auto& label: order_labels) {
+      label = labels.empty() ? label : labels[label];
+    }
+
+    auto tabu = tabu_;
+    auto cache = cache_;
+    *this = ColoringSolver();
+    tabu_ = tabu;
+    cache_ = cache;
+    graph_ = owner->view();
+    graph_owner_ = std::move(owner);
+    original_labels_ = std::move(order_labels);
+  }
+
  private:
   explicit ColoringSolver(const Edges& edges): edges_(edges) {
     for (auto& item: edges) {
@@ -170,6 +462,349 @@ class ColoringSolver {
     }
   }
 
+  // Components of a graph fed through add_edge.
+  bool solve_edges_graph_() {
+    // components come from the tracker filled by add_edge, trivial ones only need their witness
+    auto groups = [&] {
+      TraceSpan span("components");
+      return components_.groups();
+    }();
+    std::vector<const std::vector<Vertex>*> trivial;
+    for (auto& [root, group]: groups) {
+      auto& component = components_.component(root);
+      if (component.loop) {
+        return false;
+      }
+      if (component.is_trivially_colorable()) {
+        trivial.push_back(&group);
+      } else if (!solve_group_(group)) {
+        return false;
+      }
+    }
+
+    for (auto group: trivial) {
+      color_trivial_group_(*group);
+    }
+
+    return true;
+  }
+
+  // Component search straight over the CSR arrays; only the found component is copied into Edges.
+  // A precomputed core limits the search to vertexes surviving degree <= 2 peeling.
+  bool solve_graph_() {
+    GraphView graph = *graph_;
+    std::vector<Vertex> component;
+
+    auto in_core = [&](Vertex v) {
+      return graph_core_.empty() || graph_core_[v] != 0;
+    };
+    std::vector<bool> was_in(graph.n, false);
+
+    for (Vertex vertex = 0; vertex < graph.n; ++vertex) {
+      if (was_in[vertex] || graph.degree(vertex) == 0 || !in_core(vertex)) {
+        continue;
+      }
+
+      component.assign(1, vertex);
+      was_in[vertex] = true;
+
+      {
+        TraceSpan span("component_bfs");
+        for (size_t head = 0; head < component.size(); ++head) {
+          for (auto other_v: graph.adjacent(component[head])) {
+            if (!was_in[other_v] && in_core(other_v)) {
+              component.push_back(other_v);
+              was_in[other_v] = true;
+            }
+          }
+        }
+      }
+
+      if (!solve_component_(component)) {
+        return false;
+      }
+    }
+
+    color_peeled_graph_();
+    return true;
+  }
+
+  // The CSR graph itself, or the edges relabeled to 0..k-1 into storage; labels[i] is the vertex
+  // behind i, empty for the identity. Both include the renaming of reorder().
+  GraphView graph_view_(Graph& storage, std::vector<Vertex>& labels) const {
+    if (graph_) {
+      labels = original_labels_;
+      return *graph_;
+    }
+
+    labels.assign(vertexes_.begin(), vertexes_.end());
+    for (auto& item: edges_) {
+      labels.push_back(item.first);
+    }
+    std::sort(labels.begin(), labels.end());
+    labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+
+    auto index = [&](Vertex v) -> Vertex {
+      return std::lower_bound(labels.begin(), labels.end(), v) - labels.begin();
+    };
+    std::vector<std::pair<Vertex, Vertex>> edges;
+    for (auto& item: edges_) {
+      for (auto v: item.second) {
+        if (item.first <= v) {
+          edges.emplace_back(index(item.first), index(v));
+        }
+      }
+    }
+
+    storage = Graph::from_sorted_edges(labels.size(), edges);
+    if (!original_labels_.empty()) {
+      for (auto& label: labels) {
+        label = original_labels_[label];
+      }
+    }
+    return storage.view();
+  }
+
+  // Internal ids back to the vertexes of the input, after reorder().
+  Coloring original_labels_of_(Coloring coloring) const {
+    if (original_labels_.empty()) {
+      return coloring;
+    }
+    Coloring original;
+    for (auto [v, color]: coloring) {
+      original[original_labels_[v]] = color;
+    }
+    return original;
+  }
+
+  // Keeps the CSR arrays alive through owner (a coroutine parameter lives as long as the coroutine),
+  // or owns the relabeled graph; colorings are mapped back through labels.
+  static Generator<Coloring> colorings_(GraphView graph, bool csr,
+                                        [[maybe_unused]] std::shared_ptr<const void> owner, Graph storage,
+                                        std::vector<Vertex> labels, EnumerationOptions options) {
+    for (auto& coloring: enumerate_colorings(csr ? graph : storage.view(), options)) {
+      if (labels.empty()) {
+        co_yield coloring;
+        continue;
+      }
+      Coloring relabeled;
+      for (auto [v, color]: coloring) {
+        relabeled.insert(relabeled.end(), {labels[v], color});
+      }
+      co_yield relabeled;
+    }
+  }
+
+  // A trivially colorable component (see ComponentTracker::Component) is peeled away entirely by
+  // degree <= 2 peeling, so every vertex has at most two neighbours colored before it in reverse
+  // peeling order and greedy coloring needs no search.
+  void color_trivial_group_(const std::vector<Vertex>& group) {
+    static const std::set<Vertex> kNone;
+    auto adjacent = [&](Vertex v) -> const std::set<Vertex>& {
+      auto it = edges_.find(v);
+      return it != edges_.end() ? it->second : kNone;
+    };
+
+    std::unordered_map<Vertex, size_t> degree(group.size());
+    std::vector<Vertex> peeled;
+    for (auto v: group) {
+      degree[v] = adjacent(v).size();
+      if (degree[v] <= 2) {
+        peeled.push_back(v);
+      }
+    }
+    for (size_t head = 0; head < peeled.size(); ++head) {
+      for (auto u: adjacent(peeled[head])) {
+        if (--degree[u] == 2) {
+          peeled.push_back(u);
+        }
+      }
+    }
+
+    for (auto it = peeled.rbegin(); it != peeled.rend(); ++it) {
+      auto& around = adjacent(*it);
+      coloring_[*it] = free_color_(around.begin(), around.end());
+    }
+  }
+
+  bool solve_group_(const std::vector<Vertex>& group) {
+    Edges edges;
+    for (auto v: group) {
+      auto it = edges_.find(v);
+      edges[v] = it != edges_.end() ? it->second : std::set<Vertex>();
+    }
+
+    return solve_edges_(edges);
+  }
+
+  bool solve_component_(const std::vector<Vertex>& component) {
+    GraphView graph = *graph_;
+    Edges edges;
+
+    for (auto v: component) {
+      if (graph.degree(v) == 0) {
+        continue;
+      }
+
+      auto& adjacent = edges[v];
+      for (auto u: graph.adjacent(v)) {
+        if (graph_core_.empty() || graph_core_[u] != 0) {
+          adjacent.insert(adjacent.end(), u);
+        }
+      }
+    }
+
+    if (edges.empty()) {
+      return true;
+    }
+    return solve_edges_(edges);
+  }
+
+  // One component, named for checkpoints by its smallest vertex.
+  bool solve_edges_(const Edges& edges) {
+    Vertex id = edges.begin()->first;
+    if (checkpoint_) {
+      if (auto coloring = checkpoint_->solved(id)) {
+        coloring_.insert(coloring->begin(), coloring->end());
+        return true;
+      }
+      checkpoint_->begin_component(id);
+    }
+
+    ColoringSolver connected(edges);
+    connected.checkpoint_ = checkpoint_;
+    connected.nogood_options_ = nogood_options_;
+    connected.cache_ = cache_;
+    bool colorable = connected.solve_connected();
+    nogood_stats_ += connected.nogood_stats_;
+    if (checkpoint_) {
+      checkpoint_->finish_component(id, colorable ? &connected.coloring_ : nullptr);
+    }
+    if (auto progress = SearchProgress::current()) {
+      progress->finish_component();
+    }
+    if (!colorable) {
+      return false;
+    }
+    coloring_.merge(connected.coloring_);
+    return true;
+  }
+
+  // Vertexes outside of the precomputed core and isolated ones get no color from solve_component_.
+  // Peeling the CSR again gives an order in which each of them has at most two neighbours colored
+  // before it, walking it backwards colors them all.
+  void color_peeled_graph_() {
+    GraphView graph = *graph_;
+    std::vector<size_t> degree(graph.n);
+    std::vector<bool> in_core(graph.n, true);
+    std::vector<Vertex> peeled;
+
+    for (Vertex v = 0; v < graph.n; ++v) {
+      degree[v] = graph.degree(v);
+      if (degree[v] <= 2) {
+        in_core[v] = false;
+        peeled.push_back(v);
+      }
+    }
+    for (size_t head = 0; head < peeled.size(); ++head) {
+      for (auto u: graph.adjacent(peeled[head])) {
+        if (in_core[u] && --degree[u] <= 2) {
+          in_core[u] = false;
+          peeled.push_back(u);
+        }
+      }
+    }
+
+    for (auto it = peeled.rbegin(); it != peeled.rend(); ++it) {
+      if (!coloring_.contains(*it)) {
+        auto adjacent = graph.adjacent(*it);
+        coloring_[*it] = free_color_(adjacent.begin(), adjacent.end());
+      }
+    }
+  }
+
+  template<class Iterator>
+  Color free_color_(Iterator begin, Iterator end) const {
+    std::array<bool, colors_.size()> used{};
+    for (; begin != end; ++begin) {
+      auto it = coloring_.find(*begin);
+      if (it != coloring_.end()) {
+        used[it->second] = true;
+      }
+    }
+    return static_cast<Color>(std::find(used.begin(), used.end(), false) - used.begin());
+  }
+
+  // Colors dropped vertexes back, latest first; edges are the ones from before the dropping.
+  void color_peeled_(const Edges& edges, const std::vector<Vertex>& peeled) {
+    for (auto it = peeled.rbegin(); it != peeled.rend(); ++it) {
+      auto& adjacent = edges.at(*it);
+      coloring_[*it] = free_color_(adjacent.begin(), adjacent.end());
+    }
+  }
+
+  void materialize_edges_() {
+    GraphView graph = *graph_;
+    auto owner = std::move(graph_owner_);
+    graph_.reset();
+    graph_core_ = {};
+
+    create_vertexes(graph.n);
+    add_all_colors();
+    for (Vertex v = 0; v < graph.n; ++v) {
+      auto adjacent = graph.adjacent(v);
+      if (!adjacent.empty()) {
+        edges_[v].insert(adjacent.begin(), adjacent.end());
+      }
+    }
+  }
+
+  bool stupid_solve_() {
+    Deadline::check();
+    if (graph_) {
+      materialize_edges_();
+    }
+
+    auto v = *vertexes_.begin();
+    if (v == 5) {
+//      std::cout << v << "\n";
+    }
+
+    if (vertexes_.size() == 1) {
+      if (!allowed_colors_[v].empty()) {
+        coloring_[v] = *allowed_colors_[v].begin();
+        return true;
+      } else {
+        return false;
+      }
+    }
+
+    if (allowed_colors_[v].empty()) {
+      return false;
+    }
+
+    for (auto color: allowed_colors_[v]) {
+      auto copy = *this;
+
+      for (auto u: edges_[v]) {
+        copy.drop_allow_color(u, color);
+        if (copy.allowed_colors_[u].empty()) {
+          continue;
+        }
+      }
+
+      copy.drop_vertex(v);
+
+      if (copy.stupid_solve_()) {
+        coloring_ = copy.coloring_;
+        coloring_[v] = color;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
   bool check_coloring_(const Coloring& coloring) {
     for (auto& item: coloring) {
       for (auto v: edges_[item.first]) {
@@ -182,7 +817,33 @@ class ColoringSolver {
     return true;
   }
 
-  void drop_2_deg_vertexes_() {
+  // Whether coloring colors exactly the vertexes of edges_ with three colors, properly; one lookup per edge.
+  bool colors_core_(const Coloring& coloring) const {
+    if (coloring.size() != edges_.size()) {
+      return false;
+    }
+    auto color = coloring.begin();
+    for (auto& [v, neighbours]: edges_) {
+      if (color->first != v || color->second >= 3) {
+        return false;
+      }
+      ++color;
+    }
+    for (auto& [v, neighbours]: edges_) {
+      auto own = coloring.at(v);
+      for (auto u: neighbours) {
+        if (coloring.at(u) == own) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // Returns the dropped vertexes in order; each had at most two neighbours left when dropped.
+  std::vector<Vertex> drop_2_deg_vertexes_() {
+    TraceSpan span("drop_2_deg_vertexes");
+    std::vector<Vertex> peeled;
     bool dropped = true;
 
     while (dropped) {
@@ -194,12 +855,16 @@ class ColoringSolver {
           dropped = true;
 
           drop_vertex(item.first);
+          peeled.push_back(item.first);
         }
       }
     }
+
+    return peeled;
   }
 
   void make_forest_() {
+    TraceSpan span("make_forest");
     std::set<Vertex> X;
     std::set<Vertex> Y;
 
@@ -242,6 +907,7 @@ class ColoringSolver {
   }
 
   std::set<Vertex> get_coloring_vertexes_() {
+    TraceSpan span("get_coloring_vertexes");
 //    std::map<Vertex, std::set<Vertex>> coloring_vertexes_;
     std::set<Vertex> coloring_vertexes;
 
@@ -375,65 +1041,357 @@ class ColoringSolver {
   }
 
 
-  bool solve_connected() {
-    add_all_colors();
-    drop_2_deg_vertexes_();
+  struct SeedSearch {
+    std::vector<Vertex> seeds;
+    std::optional<BitPropagator> propagator;
+    SSS<3, 2> base;
+    Coloring assignment;
+    const Edges& edges;  // before peeling
+    const std::vector<Vertex>& peeled;
+    NogoodStore* nogoods = nullptr;
+  };
+
+  // Seeds are colored one per level of a depth-first tree: a child starts from the propagated domains
+  // and the SSS of its parent, so assignments with a common prefix share its work, and a color
+  // already gone from a seed's domain cuts the whole subtree. All colors are allowed everywhere
+  // at the start, so colors follow a restricted growth string (at most one more than the largest
+  // used one) and renamings of earlier assignments are skipped. weight is the share of the seed
+  // space under this node, for SearchProgress.
+  bool search_seeds_(SeedSearch& search, size_t level, const BitDomains& domains, const SSS<3, 2>& sss,
+                     size_t used_colors, double weight) {
+    Vertex seed = search.seeds[level];
+    bool last = level + 1 == search.seeds.size();
+    auto progress = SearchProgress::current();
+    Color end = std::min(used_colors + 1, colors_.size());
+    double child_weight = weight / static_cast<double>(end);
+
+    Color first = checkpoint_ ? checkpoint_->first_color(level) : 0;
+    if (progress) {
+      progress->refuted(child_weight * first);  // completed before the checkpoint
+    }
+    for (Color color = first; color < end; ++color) {
+      Deadline::check();
+      if (checkpoint_) {
+        checkpoint_->enter(level, color);
+      }
+      BitDomains child_domains;
+      bool open = true;
+      if (search.propagator) {
+        if (!domains.has(search.propagator->index(seed), color)) {
+          open = false;
+        } else {
+          child_domains = domains;
+          search.propagator->assign(child_domains, seed, color);
+          open = search.propagator->propagate(child_domains);
+        }
+      } else {
+        open = !has_neighbour_colored_(search.assignment, seed, color);
+      }
+      if (open && search.nogoods) {
+        open = !search.nogoods->violated({seed, color}, search.assignment);
+      }
+      if (!open) {
+        if (progress) {
+          progress->refuted(child_weight);
+        }
+        continue;
+      }
 
-    if (vertexes_.empty()) {
-      return true;
+      TraceSpan span("seed", TraceSpan::Kind::kSearch);
+      auto child = sss;
+      if (search.propagator) {
+        search.propagator->for_each_removed(domains, child_domains, [&](Vertex vertex, Color removed) {
+          if (child.has_vertex(vertex)) {
+            child.drop_allow_color({vertex, removed});
+          }
+        });
+      }
+      search.assignment[seed] = color;
+      set_coloring_vertexes_({{seed, color}}, child);
+
+      if (last ? finish_seeds_(search, child, child_weight)
+               : search_seeds_(search, level + 1, child_domains, child, std::max(used_colors, color + 1),
+                               child_weight)) {
+        return true;
+      }
+      search.assignment.erase(seed);
     }
 
-    make_forest_();
+    return false;
+  }
+
+  // Leaf of the seed tree: its SSS is solved in place.
+  bool finish_seeds_(SeedSearch& search, SSS<3, 2>& sss, double weight) {
+    TraceSpan span("sss", TraceSpan::Kind::kSearch);
+    auto progress = SearchProgress::current();
+    uint64_t nodes = progress ? progress->nodes() : 0;
+    NodeBudget budget;
+    bool solved = search.nogoods ? *sss.solve(budget) : sss.solve();
+    if (progress) {
+      progress->leaf(progress->nodes() - nodes);
+    }
+    if (!solved && search.nogoods) {
+      learn_nogood_(search, budget.used);
+    }
 
-    auto coloring_vertex = get_coloring_vertexes_();
-    auto sss = make_SSS_();
-    std::vector<Color> coloring_vec;
-    Coloring coloring;
+    // seeds and the vertexes they forced are not in the SSS witness, the base SSS fills them
+    Coloring witness;
+    if (solved) {
+      witness = std::move(sss.coloring);
+      witness.insert(search.assignment.begin(), search.assignment.end());
+      solved = search.base.complete_coloring(witness);
+    }
+    if (!solved) {
+      if (progress) {
+        progress->refuted(weight);
+      }
+      return false;
+    }
+
+    coloring_ = std::move(witness);
+    color_peeled_(search.edges, search.peeled);
+    return true;
+  }
 
-    for (auto v: coloring_vertex) {
-      coloring[v] = 0;
+  // Shrinks the seed colors of a refuted leaf to a subset that still refutes the core and stores it:
+  // seeds are dropped from the shallowest while a re-solve within the node budget of the leaf
+  // refutes the rest. Shallow seeds go first, so the nogood cuts the most of the tree.
+  void learn_nogood_(SeedSearch& search, uint64_t leaf_nodes) {
+    auto& store = *search.nogoods;
+    auto& options = store.options();
+    std::vector<Pair> nogood;
+    for (auto seed: search.seeds) {
+      nogood.push_back({seed, search.assignment.at(seed)});
     }
 
-    while (true) {
-      bool end = true;
-      for (auto& item: coloring) {
-        if (item.second != 2) {
-          ++item.second;
-          end = false;
+    size_t checks = 0;
+    for (size_t i = 0; i < nogood.size() && nogood.size() > 1;) {
+      // pairs before i are kept, checks left can't drop the rest below max_size
+      size_t droppable = std::min(nogood.size() - i, options.max_checks - checks);
+      if (nogood.size() - droppable > options.max_size) {
+        return;
+      }
+
+      auto candidate = nogood;
+      candidate.erase(candidate.begin() + static_cast<ptrdiff_t>(i));
+      bool refuted = store.contains_nogood(candidate);
+      if (!refuted) {
+        if (checks == options.max_checks) {
           break;
-        } else {
-          item.second = 0;
         }
+        ++checks;
+        store.count_check();
+        refuted = refutes_(search, candidate, leaf_nodes + options.check_nodes);
       }
-
-      if (end) {
-        break;
+      if (refuted) {
+        nogood = std::move(candidate);
+      } else {
+        ++i;
       }
+    }
+    store.learn(nogood);
+  }
 
-      if (!check_coloring_(coloring)) {
-        break;
+  // Whether coloring the seeds of pairs alone leaves the core uncolorable, within a node budget;
+  // false when the budget runs out.
+  bool refutes_(SeedSearch& search, const std::vector<Pair>& pairs, uint64_t max_nodes) {
+    auto sss = search.base;
+    Coloring assignment;
+    if (search.propagator) {
+      auto full = search.propagator->full_domains();
+      auto domains = full;
+      for (auto [seed, color]: pairs) {
+        if (!domains.has(search.propagator->index(seed), color)) {
+          return true;
+        }
+        search.propagator->assign(domains, seed, color);
       }
-
-      auto sss_copy = sss;
-      set_coloring_vertexes_(coloring, sss_copy);
-      if (sss_copy.solve()) {
-        coloring_ = sss_copy.coloring;
+      if (!search.propagator->propagate(domains)) {
         return true;
       }
+      search.propagator->for_each_removed(full, domains, [&](Vertex vertex, Color removed) {
+        if (sss.has_vertex(vertex)) {
+          sss.drop_allow_color({vertex, removed});
+        }
+      });
     }
+    for (auto [seed, color]: pairs) {
+      if (has_neighbour_colored_(assignment, seed, color)) {
+        return true;
+      }
+      assignment[seed] = color;
+    }
+    set_coloring_vertexes_(assignment, sss);
 
+    NodeBudget budget{max_nodes};
+    auto ans = sss.solve(budget);
+    return ans && !*ans;
+  }
+
+  bool has_neighbour_colored_(const Coloring& coloring, Vertex vertex, Color color) {
+    for (auto v: edges_[vertex]) {
+      auto it = coloring.find(v);
+      if (it != coloring.end() && it->second == color) {
+        return true;
+      }
+    }
     return false;
   }
 
+  bool solve_connected() {
+    TraceSpan span("solve_connected");
+    add_all_colors();
+    auto edges = edges_;
+    auto peeled = drop_2_deg_vertexes_();
+
+    if (vertexes_.empty()) {
+      coloring_.clear();
+      color_peeled_(edges, peeled);
+      return true;
+    }
+
+    // bipartite, max degree 3 and chordal cores have linear time answers
+    std::optional<FastPathAnswer> fast;
+    {
+      TraceSpan span("fast_paths");
+      fast = FastPaths::solve(edges_);
+    }
+    if (fast) {
+      TraceSpan span(fast_path_name(fast->path));
+      if (!fast->colorable) {
+        return false;
+      }
+      coloring_ = std::move(fast->coloring);
+      color_peeled_(edges, peeled);
+      return true;
+    }
+
+    // recurring core shapes are answered from the cache
+    std::optional<CanonicalForm> form;
+    if (cache_ != nullptr && cache_->accepts(vertexes_.size())) {
+      {
+        TraceSpan span("canonical_form");
+        form = cache_->canonical_form(edges_);
+      }
+      if (auto entry = cache_->find(*form)) {
+        if (!entry->colorable) {
+          return false;
+        }
+        auto witness = ComponentCache::relabel(*form, *entry);
+        if (colors_core_(witness)) {
+          coloring_ = std::move(witness);
+          color_peeled_(edges, peeled);
+          return true;
+        }
+        cache_->reject(*form);  // a damaged entry, search again and store the fresh answer
+      }
+    }
+
+    bool colorable = search_core_(edges, peeled);
+    if (form) {
+      cache_->insert(*form, colorable, coloring_);
+    }
+    return colorable;
+  }
+
+  // Seed search and SSS over the peeled core.
+  bool search_core_(const Edges& edges, const std::vector<Vertex>& peeled) {
+    make_forest_();
+
+    auto seeds = get_coloring_vertexes_();
+    SeedSearch search{{seeds.begin(), seeds.end()}, std::nullopt, make_SSS_(), {}, edges, peeled};
+    if (vertexes_.size() <= BitPropagator::kMaxVertexes) {
+      search.propagator.emplace(edges_);
+    }
+
+    std::optional<NogoodStore> nogoods;
+    if (nogood_options_) {
+      search.nogoods = &nogoods.emplace(*nogood_options_);
+    }
+
+    auto domains = search.propagator ? search.propagator->full_domains() : BitDomains();
+    if (auto progress = SearchProgress::current()) {
+      progress->begin_component(search.seeds.empty() ? 1 : estimate_seed_leaves_(search, domains));
+    }
+    bool colorable;
+    if (search.seeds.empty()) {
+      auto sss = search.base;
+      colorable = finish_seeds_(search, sss, 1);
+    } else {
+      colorable = search_seeds_(search, 0, domains, search.base, 0, 1);
+    }
+    if (nogoods) {
+      nogood_stats_ += nogoods->stats();
+    }
+    return colorable;
+  }
+
+  // Knuth's estimate of the number of seed tree leaves that reach an SSS: a dive colors the seeds
+  // in order with a random open color and its estimate is the product of the open colors met
+  // (zero at a dead end), the mean of the dives is unbiased.
+  double estimate_seed_leaves_(SeedSearch& search, const BitDomains& domains) {
+    constexpr size_t kDives = 64;
+    std::mt19937_64 random(search.seeds.size());
+    std::vector<std::pair<Color, BitDomains>> open;
+    double total = 0;
+
+    for (size_t dive = 0; dive < kDives; ++dive) {
+      BitDomains current = domains;
+      Coloring assignment;
+      size_t used_colors = 0;
+      double leaves = 1;
+
+      for (auto seed: search.seeds) {
+        open.clear();
+        for (Color color = 0; color < std::min(used_colors + 1, colors_.size()); ++color) {
+          if (search.propagator) {
+            if (!current.has(search.propagator->index(seed), color)) {
+              continue;
+            }
+            auto child = current;
+            search.propagator->assign(child, seed, color);
+            if (search.propagator->propagate(child)) {
+              open.emplace_back(color, std::move(child));
+            }
+          } else if (!has_neighbour_colored_(assignment, seed, color)) {
+            open.emplace_back(color, BitDomains());
+          }
+        }
+        if (open.empty()) {
+          leaves = 0;
+          break;
+        }
+
+        leaves *= static_cast<double>(open.size());
+        auto& [color, child] = open[random() % open.size()];
+        assignment[seed] = color;
+        current = std::move(child);
+        used_colors = std::max<size_t>(used_colors, color + 1);
+      }
+      total += leaves;
+    }
+    return total / kDives;
+  }
+
  private:
+  std::optional<TabuOptions> tabu_;
+  std::optional<GraphView> graph_;
+  std::span<const uint8_t> graph_core_;
+  std::shared_ptr<const void> graph_owner_;
+  std::vector<Vertex> original_labels_;  // input vertex behind each internal id, see reorder()
+  std::shared_ptr<Checkpointer> checkpoint_;
+  std::optional<NogoodOptions> nogood_options_;
+  NogoodStats nogood_stats_;
+  ComponentCache* cache_ = &ComponentCache::global();
   std::set<Vertex> vertexes_;
   Edges edges_;
+  ComponentTracker components_;
 
   Forest forest_;
 //  std::map<Vertex, Forest::iterator> vertex_tree_;
 
   std::map<Vertex, std::set<Color>> allowed_colors_;
-  std::set<Color> colors_ = {0, 1, 2};
+  static constexpr auto colors_ = ColorTable<3>::colors;
 
  public:
   Coloring coloring_;
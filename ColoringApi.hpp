@@ -0,0 +1,42 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__COLORING_API_HPP_
+#define INC_3COLORING__COLORING_API_HPP_
+
+#include <cstddef>
+#include <span>
+
+// Entry point of the coloring3 library. It depends on the standard library only, so the solver
+// headers stay an implementation detail of coloring_api.cpp.
+
+enum class ColoringStatus : int {
+  kColorable = 0,
+  kNotColorable = 1,
+  kInvalidGraph = 2,    // offsets/neighbours are not a sorted, symmetric CSR graph on n vertexes
+  kOutputTooSmall = 3,  // colors has fewer than n entries
+  kError = 4,           // the solver failed, e.g. out of memory
+};
+
+// CSR graph borrowed from the caller: neighbours of v are neighbours[offsets[v] .. offsets[v + 1]),
+// sorted, and u is a neighbour of v exactly when v is a neighbour of u.
+struct ColoringGraph {
+  size_t n = 0;
+  std::span<const size_t> offsets;     // n + 1 entries
+  std::span<const size_t> neighbours;  // offsets[n] entries
+};
+
+// Decides whether the graph is 3-colorable; if it is, colors[v] in {0, 1, 2} is a proper coloring.
+// The input is read in place, never copied as a whole nor kept after the call. Reentrant: any
+// number of threads may solve different graphs at once. The answer depends on the graph only; the
+// process-wide state the call touches is
+//  - the node pool: per-thread free lists of solver memory, kept for reuse until the process ends;
+//  - the fast path counters: relaxed atomic statistics, incremented when a linear-time path answers;
+//  - the tracer: records spans only if the host process started it.
+// The component cache, environment variables and profile files are not used.
+ColoringStatus solve_3coloring(ColoringGraph graph, std::span<size_t> colors) noexcept;
+
+const char* coloring_status_name(ColoringStatus status) noexcept;
+
+#endif //INC_3COLORING__COLORING_API_HPP_
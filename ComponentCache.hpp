@@ -0,0 +1,480 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__COMPONENT_CACHE_HPP_
+#define INC_3COLORING__COMPONENT_CACHE_HPP_
+
+#include "Graph.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdlib>
+#include <fstream>
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Canonical labeling of a small graph by partition refinement with individualisation. Vertexes are
+// split by degree and refined until every vertex of a cell has the same number of neighbours in
+// each cell; a cell that stays non-trivial is broken by individualising each of its vertexes in
+// turn. Every discrete partition reached is a labeling, the one with the lexicographically least
+// adjacency rows is canonical.
+//
+// Without automorphism pruning the search tree of a very symmetric graph is as large as its
+// automorphism group, so it stops after max_leaves labelings. The best labeling found so far is
+// still a relabeling of the graph: a truncated search only costs cache hits, never correctness,
+// because the key is the whole relabeled adjacency and not a hash of it.
+class CanonicalForm {
+ public:
+  static constexpr size_t kMaxVertexes = 64;
+
+  // edges must be symmetric, every neighbour is a key too.
+  static CanonicalForm of(const std::map<Vertex, std::set<Vertex>>& edges, size_t max_leaves) {
+    if (edges.size() > kMaxVertexes) {
+      throw std::runtime_error("Canonical form of more than 64 vertexes");
+    }
+
+    Search search;
+    search.max_leaves = std::max<size_t>(max_leaves, 1);
+    for (auto& item: edges) {
+      search.vertexes.push_back(item.first);
+    }
+
+    size_t k = search.vertexes.size();
+    search.adjacent.assign(k, 0);
+    std::vector<uint32_t> cells(k, 0);
+    for (size_t i = 0; i < k; ++i) {
+      for (auto u: edges.at(search.vertexes[i])) {
+        auto j = std::lower_bound(search.vertexes.begin(), search.vertexes.end(), u) - search.vertexes.begin();
+        search.adjacent[i] |= uint64_t(1) << j;
+      }
+    }
+
+    search.run(cells);
+
+    CanonicalForm form;
+    form.key_.assign(1, static_cast<char>(k));
+    form.key_.append(reinterpret_cast<const char*>(search.best.data()), search.best.size() * sizeof(uint64_t));
+    form.labels_.resize(k);
+    for (size_t i = 0; i < k; ++i) {
+      form.labels_[search.best_position[i]] = search.vertexes[i];
+    }
+    return form;
+  }
+
+  // Equal keys mean isomorphic graphs, with labels() as the isomorphism.
+  const std::string& key() const {
+    return key_;
+  }
+  // labels()[i] is the vertex at canonical position i
+  const std::vector<Vertex>& labels() const {
+    return labels_;
+  }
+
+ private:
+  struct Search {
+    std::vector<Vertex> vertexes;
+    std::vector<uint64_t> adjacent;  // by local index
+    size_t max_leaves = 0;
+    size_t leaves = 0;
+    std::vector<uint64_t> best;          // adjacency rows in canonical order
+    std::vector<uint32_t> best_position;  // canonical position of each local index
+
+    // A cell is named by its first position in the ordered partition, so a discrete partition
+    // is the labeling itself.
+    void refine(std::vector<uint32_t>& cells) const {
+      size_t k = cells.size();
+      std::vector<std::vector<uint32_t>> signatures(k);
+      std::vector<uint32_t> order(k);
+      size_t count = 0;
+
+      while (true) {
+        for (uint32_t v = 0; v < k; ++v) {
+          auto& signature = signatures[v];
+          signature.assign(k + 1, 0);
+          signature[0] = cells[v];
+          for (uint64_t rest = adjacent[v]; rest != 0; rest &= rest - 1) {
+            ++signature[1 + cells[std::countr_zero(rest)]];
+          }
+          order[v] = v;
+        }
+        std::sort(order.begin(), order.end(), [&](uint32_t v, uint32_t u) {
+          return signatures[v] < signatures[u];
+        });
+
+        size_t next_count = 0;
+        for (size_t i = 0; i < k; ++i) {
+          if (i == 0 || signatures[order[i]] != signatures[order[i - 1]]) {
+            ++next_count;
+            cells[order[i]] = static_cast<uint32_t>(i);
+          } else {
+            cells[order[i]] = cells[order[i - 1]];
+          }
+        }
+        if (next_count == count) {
+          return;
+        }
+        count = next_count;
+      }
+    }
+
+    void run(std::vector<uint32_t>& cells) {
+      refine(cells);
+
+      size_t k = cells.size();
+      std::vector<uint32_t> sizes(k, 0);
+      for (auto cell: cells) {
+        ++sizes[cell];
+      }
+      auto target = std::find_if(sizes.begin(), sizes.end(), [](uint32_t size) {
+        return size > 1;
+      });
+
+      if (target == sizes.end()) {
+        leaf(cells);
+        return;
+      }
+
+      auto cell = static_cast<uint32_t>(target - sizes.begin());
+      for (uint32_t v = 0; v < k && leaves < max_leaves; ++v) {
+        if (cells[v] != cell) {
+          continue;
+        }
+        auto child = cells;
+        for (uint32_t u = 0; u < k; ++u) {
+          if (cells[u] == cell && u != v) {
+            child[u] = cell + 1;
+          }
+        }
+        run(child);
+      }
+    }
+
+    void leaf(const std::vector<uint32_t>& cells) {
+      ++leaves;
+      std::vector<uint64_t> rows(cells.size(), 0);
+      for (size_t v = 0; v < cells.size(); ++v) {
+        for (uint64_t rest = adjacent[v]; rest != 0; rest &= rest - 1) {
+          rows[cells[v]] |= uint64_t(1) << cells[std::countr_zero(rest)];
+        }
+      }
+      if (best.empty() || rows < best) {
+        best = std::move(rows);
+        best_position = cells;
+      }
+    }
+  };
+
+  std::string key_;
+  std::vector<Vertex> labels_;
+};
+
+struct ComponentCacheOptions {
+  size_t max_vertexes = 32;   // cores larger than this are not looked up, 0 turns the cache off
+  size_t capacity = 1 << 16;  // entries; the least recently used ones are evicted
+  size_t max_leaves = 256;    // labelings tried per canonical form
+  std::string path;           // loaded by configure() and written by save() when set
+
+  // $COLORING_CACHE (path), $COLORING_CACHE_VERTEXES, $COLORING_CACHE_SIZE
+  static ComponentCacheOptions from_env() {
+    ComponentCacheOptions options;
+    if (const char* path = std::getenv("COLORING_CACHE")) {
+      options.path = path;
+    }
+    if (const char* vertexes = std::getenv("COLORING_CACHE_VERTEXES")) {
+      options.max_vertexes = std::min<size_t>(std::stoull(vertexes), CanonicalForm::kMaxVertexes);
+    }
+    if (const char* size = std::getenv("COLORING_CACHE_SIZE")) {
+      options.capacity = std::stoull(size);
+    }
+    return options;
+  }
+};
+
+// Process-wide answers for the cores of components (what is left after degree <= 2 peeling),
+// keyed by canonical form, with a witness in canonical order for the colorable ones. Recurring
+// component shapes, within a graph or across the graphs of one process, skip the seed search.
+//
+// Sharded LRU, safe to use from any number of solving threads; configure() and load() are not
+// meant to run concurrently with solves.
+class ComponentCache {
+ public:
+  struct Entry {
+    bool colorable = false;
+    std::vector<uint8_t> colors;  // by canonical position, empty if not colorable
+  };
+
+  struct Stats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t insertions = 0;
+    size_t evictions = 0;
+    size_t rejected = 0;  // hits whose witness didn't color the graph, erased
+    size_t entries = 0;
+  };
+
+  static ComponentCache& global() {
+    static ComponentCache* cache = new ComponentCache();
+    return *cache;
+  }
+
+  void configure(ComponentCacheOptions options) {
+    options.max_vertexes = std::min(options.max_vertexes, CanonicalForm::kMaxVertexes);
+    options_ = std::move(options);
+    clear();
+    if (!options_.path.empty()) {
+      load(options_.path);
+    }
+  }
+
+  const ComponentCacheOptions& options() const {
+    return options_;
+  }
+
+  bool accepts(size_t vertexes) const {
+    return vertexes > 0 && vertexes <= options_.max_vertexes;
+  }
+
+  CanonicalForm canonical_form(const std::map<Vertex, std::set<Vertex>>& edges) const {
+    return CanonicalForm::of(edges, options_.max_leaves);
+  }
+
+  std::optional<Entry> find(const CanonicalForm& form) {
+    auto& shard = shard_(form.key());
+    std::lock_guard lock(shard.mutex);
+    auto it = shard.index.find(form.key());
+    if (it == shard.index.end()) {
+      misses_.fetch_add(1, std::memory_order_relaxed);
+      return std::nullopt;
+    }
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    shard.lru.splice(shard.lru.end(), shard.lru, it->second);
+    return it->second->second;
+  }
+
+  // coloring must color every vertex of the form when colorable.
+  void insert(const CanonicalForm& form, bool colorable, const Coloring& coloring) {
+    Entry entry{colorable, {}};
+    if (colorable) {
+      for (auto v: form.labels()) {
+        entry.colors.push_back(static_cast<uint8_t>(coloring.at(v)));
+      }
+    }
+    insert_(form.key(), std::move(entry));
+  }
+
+  // Drops the entry of form after its witness failed to color the graph.
+  void reject(const CanonicalForm& form) {
+    rejected_.fetch_add(1, std::memory_order_relaxed);
+    auto& shard = shard_(form.key());
+    std::lock_guard lock(shard.mutex);
+    auto it = shard.index.find(form.key());
+    if (it != shard.index.end()) {
+      shard.lru.erase(it->second);
+      shard.index.erase(it);
+    }
+  }
+
+  // The witness of a colorable entry for the graph of form.
+  static Coloring relabel(const CanonicalForm& form, const Entry& entry) {
+    Coloring coloring;
+    for (size_t i = 0; i < entry.colors.size(); ++i) {
+      coloring[form.labels()[i]] = entry.colors[i];
+    }
+    return coloring;
+  }
+
+  Stats stats() const {
+    Stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.insertions = insertions_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    stats.rejected = rejected_.load(std::memory_order_relaxed);
+    for (auto& shard: shards_) {
+      std::lock_guard lock(shard.mutex);
+      stats.entries += shard.lru.size();
+    }
+    return stats;
+  }
+
+  void clear() {
+    for (auto& shard: shards_) {
+      std::lock_guard lock(shard.mutex);
+      shard.lru.clear();
+      shard.index.clear();
+    }
+  }
+
+  // File layout (native byte order): kMagic, uint64 kVersion, uint64 entries, then per entry,
+  // least recently used first: uint64 key size, key, uint8 colorable, colors (one byte per vertex
+  // of the key); last a uint64 FNV-1a checksum of the entries.
+  // A missing file, or one of another version, is an empty cache; a malformed one throws. Witnesses
+  // are checked again on every hit (see ColoringSolver::solve_connected), "not colorable" entries
+  // rest on the checksum.
+  void load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+      return;
+    }
+
+    char magic[sizeof(kMagic)] = {};
+    uint64_t version = 0, count = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    if (!file || !std::equal(magic, magic + sizeof(magic), kMagic)) {
+      throw std::runtime_error("File " + path + " is not a component cache");
+    }
+    if (version != kVersion) {
+      return;  // written by another version of the solver; save() replaces it
+    }
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+
+    Checksum checksum;
+    std::vector<std::pair<std::string, Entry>> entries;
+    for (uint64_t i = 0; i < count && file; ++i) {
+      uint64_t size = 0;
+      file.read(reinterpret_cast<char*>(&size), sizeof(size));
+      if (!file || size == 0 || size > 1 + CanonicalForm::kMaxVertexes * sizeof(uint64_t)) {
+        throw std::runtime_error("Component cache " + path + " is malformed");
+      }
+      std::string key(size, '\0');
+      file.read(key.data(), static_cast<std::streamsize>(size));
+
+      Entry entry;
+      char colorable = 0;
+      file.read(&colorable, 1);
+      entry.colorable = colorable != 0;
+      if (entry.colorable) {
+        entry.colors.resize(static_cast<uint8_t>(key[0]));
+        file.read(reinterpret_cast<char*>(entry.colors.data()), static_cast<std::streamsize>(entry.colors.size()));
+      }
+      if (std::any_of(entry.colors.begin(), entry.colors.end(), [](uint8_t color) { return color >= 3; })) {
+        throw std::runtime_error("Component cache " + path + " is malformed");
+      }
+      checksum.add(key, entry);
+      entries.emplace_back(std::move(key), std::move(entry));
+    }
+
+    uint64_t expected = 0;
+    file.read(reinterpret_cast<char*>(&expected), sizeof(expected));
+    if (!file) {
+      throw std::runtime_error("Component cache " + path + " is truncated");
+    }
+    if (expected != checksum.hash) {
+      throw std::runtime_error("Component cache " + path + " is corrupt");
+    }
+    for (auto& [key, entry]: entries) {
+      insert_(key, std::move(entry));
+    }
+  }
+
+  void save(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+      throw std::runtime_error("Can't create file " + path);
+    }
+
+    uint64_t count = stats().entries;
+    file.write(kMagic, sizeof(kMagic));
+    file.write(reinterpret_cast<const char*>(&kVersion), sizeof(kVersion));
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    Checksum checksum;
+    for (auto& shard: shards_) {
+      std::lock_guard lock(shard.mutex);
+      for (auto& [key, entry]: shard.lru) {
+        uint64_t size = key.size();
+        char colorable = entry.colorable;
+        file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        file.write(key.data(), static_cast<std::streamsize>(size));
+        file.write(&colorable, 1);
+        file.write(reinterpret_cast<const char*>(entry.colors.data()), static_cast<std::streamsize>(entry.colors.size()));
+        checksum.add(key, entry);
+      }
+    }
+    file.write(reinterpret_cast<const char*>(&checksum.hash), sizeof(checksum.hash));
+    if (!file) {
+      throw std::runtime_error("Can't write file " + path);
+    }
+  }
+
+  void save() const {
+    if (!options_.path.empty()) {
+      save(options_.path);
+    }
+  }
+
+ private:
+  static constexpr char kMagic[8] = {'3', 'C', 'O', 'L', 'C', 'C', 'H', '\0'};
+  static constexpr uint64_t kVersion = 2;  // bump when CanonicalForm keys or the layout change
+  static constexpr size_t kShards = 16;
+
+  struct Shard {
+    mutable std::mutex mutex;
+    std::list<std::pair<std::string, Entry>> lru;  // most recently used last
+    std::unordered_map<std::string, std::list<std::pair<std::string, Entry>>::iterator> index;
+  };
+
+  // FNV-1a over the entries as they are written.
+  struct Checksum {
+    uint64_t hash = 14695981039346656037ull;
+
+    void add(const std::string& key, const Entry& entry) {
+      mix_(key.size());
+      for (auto byte: key) {
+        mix_(static_cast<uint8_t>(byte));
+      }
+      mix_(entry.colorable);
+      for (auto color: entry.colors) {
+        mix_(color);
+      }
+    }
+
+   private:
+    void mix_(uint64_t value) {
+      hash = (hash ^ value) * 1099511628211ull;
+    }
+  };
+
+  ComponentCache() = default;
+
+  Shard& shard_(const std::string& key) {
+    return shards_[std::hash<std::string>()(key) % kShards];
+  }
+
+  void insert_(const std::string& key, Entry entry) {
+    auto& shard = shard_(key);
+    std::lock_guard lock(shard.mutex);
+    if (shard.index.contains(key)) {
+      return;
+    }
+
+    size_t capacity = std::max<size_t>(options_.capacity / kShards, 1);
+    while (shard.lru.size() >= capacity) {
+      shard.index.erase(shard.lru.front().first);
+      shard.lru.pop_front();
+      evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+    shard.lru.emplace_back(key, std::move(entry));
+    shard.index.emplace(key, std::prev(shard.lru.end()));
+    insertions_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  ComponentCacheOptions options_;
+  std::array<Shard, kShards> shards_;
+  std::atomic<size_t> hits_ = 0;
+  std::atomic<size_t> misses_ = 0;
+  std::atomic<size_t> insertions_ = 0;
+  std::atomic<size_t> evictions_ = 0;
+  std::atomic<size_t> rejected_ = 0;
+};
+
+#endif //INC_3COLORING__COMPONENT_CACHE_HPP_
@@ -0,0 +1,107 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__COMPONENTS_HPP_
+#define INC_3COLORING__COMPONENTS_HPP_
+
+#include "SSS.hpp"
+#include <unordered_map>
+#include <utility>
+
+// Union-find over the vertexes of a graph that arrives edge by edge, with per-component counters,
+// so components are known the moment the feed ends.
+class ComponentTracker {
+ public:
+  struct Component {
+    size_t vertexes = 1;
+    size_t edges = 0;
+    size_t high_degree = 0;  // vertexes of degree >= 3
+    bool loop = false;
+
+    // Max degree <= 2 (paths, cycles) or edges <= vertexes (trees, one cycle): peeling of
+    // degree <= 2 vertexes removes everything, so it is colorable without any search.
+    bool is_trivially_colorable() const {
+      return !loop && (high_degree == 0 || edges <= vertexes);
+    }
+  };
+
+  void add_vertex(Vertex vertex) {
+    parent_.try_emplace(vertex, vertex);
+    components_.try_emplace(vertex);
+  }
+
+  // Call once per new edge; degrees are the ones after the edge was added.
+  void add_edge(Vertex v1, Vertex v2, size_t degree1, size_t degree2) {
+    add_vertex(v1);
+    add_vertex(v2);
+
+    Vertex root = unite_(find(v1), find(v2));
+    auto& component = components_.at(root);
+    ++component.edges;
+    component.loop |= v1 == v2;
+    component.high_degree += degree1 == 3;
+    if (v1 != v2) {
+      component.high_degree += degree2 == 3;
+    }
+  }
+
+  Vertex find(Vertex vertex) {
+    Vertex root = vertex;
+    while (parent_.at(root) != root) {
+      root = parent_.at(root);
+    }
+    while (vertex != root) {
+      vertex = std::exchange(parent_.at(vertex), root);
+    }
+    return root;
+  }
+
+  const Component& component(Vertex vertex) {
+    return components_.at(find(vertex));
+  }
+
+  size_t size() const {
+    return components_.size();
+  }
+  bool empty() const {
+    return parent_.empty();
+  }
+
+  // root -> vertexes of its component
+  std::map<Vertex, std::vector<Vertex>> groups() {
+    std::map<Vertex, std::vector<Vertex>> groups;
+    for (auto& item: parent_) {
+      groups[find(item.first)].push_back(item.first);
+    }
+    return groups;
+  }
+
+ private:
+  // union by size, returns the new root
+  Vertex unite_(Vertex root1, Vertex root2) {
+    if (root1 == root2) {
+      return root1;
+    }
+
+    if (components_.at(root1).vertexes < components_.at(root2).vertexes) {
+      std::swap(root1, root2);
+    }
+
+    auto& big = components_.at(root1);
+    auto& small = components_.at(root2);
+    big.vertexes += small.vertexes;
+    big.edges += small.edges;
+    big.high_degree += small.high_degree;
+    big.loop |= small.loop;
+
+    parent_[root2] = root1;
+    components_.erase(root2);
+    return root1;
+  }
+
+  std::unordered_map<Vertex, Vertex> parent_;
+  std::unordered_map<Vertex, Component> components_;  // by root
+};
+
+#endif //INC_3COLORING__COMPONENTS_HPP_
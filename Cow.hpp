@@ -0,0 +1,211 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__COW_HPP_
+#define INC_3COLORING__COW_HPP_
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Copy-on-write value: copies share one immutable instance, the first write through mutate()
+// clones it if somebody else still holds it. A copy is O(1) and can be read from other threads.
+template<class T>
+class Cow {
+ public:
+  Cow(): data_(std::make_shared<T>()) {}
+  Cow(T value): data_(std::make_shared<T>(std::move(value))) {}
+
+  Cow& operator=(T value) {
+    data_ = std::make_shared<T>(std::move(value));
+    return *this;
+  }
+
+  const T& operator*() const {
+    return *data_;
+  }
+  const T* operator->() const {
+    return data_.get();
+  }
+
+  // Iterators taken before mutate() may point into the shared instance, take them after it.
+  T& mutate() {
+    if (data_.use_count() != 1) {
+      data_ = std::make_shared<T>(std::as_const(*data_));
+    }
+    return *data_;
+  }
+
+  std::shared_ptr<const T> snapshot() const {
+    return data_;
+  }
+
+  bool is_shared() const {
+    return data_.use_count() != 1;
+  }
+
+ private:
+  std::shared_ptr<T> data_;
+};
+
+// Ordered set or map split into Cow shards by key: copies share every shard and a change clones
+// only the shard it touches, so a copy costs one reference per shard instead of one node per
+// element. ShardOf maps a key to a small shard index (keys are dense ids); iteration goes through
+// the shards in index order, which is key order when ShardOf is monotone.
+template<class Container, class ShardOf>
+class ShardedCow {
+  using Shards = std::vector<Cow<Container>>;
+  static constexpr bool kIsMap = requires { typename Container::mapped_type; };
+
+ public:
+  using key_type = typename Container::key_type;
+  using value_type = typename Container::value_type;
+
+  // Like the iterators of Container, valid until the shard it points into is changed.
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = typename Container::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    const_iterator() = default;
+
+    reference operator*() const {
+      return *inner_;
+    }
+    pointer operator->() const {
+      return &*inner_;
+    }
+
+    const_iterator& operator++() {
+      ++inner_;
+      skip_empty_();
+      return *this;
+    }
+    const_iterator operator++(int) {
+      auto copy = *this;
+      ++*this;
+      return copy;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return shard_ == other.shard_ && (shard_ == shards_->size() || inner_ == other.inner_);
+    }
+
+   private:
+    friend class ShardedCow;
+
+    const_iterator(const Shards* shards, size_t shard, typename Container::const_iterator inner):
+        shards_(shards), shard_(shard), inner_(inner) {
+      if (shard_ != shards_->size()) {
+        end_ = (*shards_)[shard_]->end();
+      }
+    }
+
+    void skip_empty_() {
+      while (inner_ == end_) {
+        if (++shard_ == shards_->size()) {
+          return;
+        }
+        inner_ = (*shards_)[shard_]->begin();
+        end_ = (*shards_)[shard_]->end();
+      }
+    }
+
+    const Shards* shards_ = nullptr;
+    size_t shard_ = 0;
+    typename Container::const_iterator inner_, end_;
+  };
+
+  const_iterator begin() const {
+    if (shards_.empty()) {
+      return end();
+    }
+    const_iterator it(&shards_, 0, shards_[0]->begin());
+    it.skip_empty_();
+    return it;
+  }
+  const_iterator end() const {
+    return const_iterator(&shards_, shards_.size(), {});
+  }
+
+  size_t size() const {
+    return size_;
+  }
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  const_iterator find(const key_type& key) const {
+    size_t shard = ShardOf()(key);
+    if (shard >= shards_.size()) {
+      return end();
+    }
+    auto it = shards_[shard]->find(key);
+    return it == shards_[shard]->end() ? end() : const_iterator(&shards_, shard, it);
+  }
+  bool contains(const key_type& key) const {
+    size_t shard = ShardOf()(key);
+    return shard < shards_.size() && shards_[shard]->contains(key);
+  }
+
+  bool insert(const value_type& value) {
+    bool inserted = mutate_shard_(key_of_(value)).insert(value).second;
+    size_ += inserted;
+    return inserted;
+  }
+  template<class Iterator>
+  void insert(Iterator first, Iterator last) {
+    for (; first != last; ++first) {
+      insert(*first);
+    }
+  }
+
+  size_t erase(const key_type& key) {
+    if (!contains(key)) {
+      return 0;
+    }
+    shards_[ShardOf()(key)].mutate().erase(key);
+    --size_;
+    return 1;
+  }
+
+  void clear() {
+    shards_.clear();
+    size_ = 0;
+  }
+
+  // The value of key, inserted if missing, in a shard nobody else holds.
+  auto& mutate(const key_type& key) requires kIsMap {
+    auto [it, inserted] = mutate_shard_(key).try_emplace(key);
+    size_ += inserted;
+    return it->second;
+  }
+
+ private:
+  static const key_type& key_of_(const value_type& value) {
+    if constexpr (kIsMap) {
+      return value.first;
+    } else {
+      return value;
+    }
+  }
+
+  Container& mutate_shard_(const key_type& key) {
+    size_t shard = ShardOf()(key);
+    if (shard >= shards_.size()) {
+      shards_.resize(shard + 1);
+    }
+    return shards_[shard].mutate();
+  }
+
+  Shards shards_;
+  size_t size_ = 0;
+};
+
+#endif //INC_3COLORING__COW_HPP_
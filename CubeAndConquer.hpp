@@ -0,0 +1,391 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__CUBE_AND_CONQUER_HPP_
+#define INC_3COLORING__CUBE_AND_CONQUER_HPP_
+
+#include "Coloring.hpp"
+#include "Selector.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Cube-and-conquer over plain files and processes. split_work() cuts the seed tree of solve() at
+// a depth (ColoringSolver::cubes) and writes every open cube as a self-contained work unit: the
+// whole graph and the seed colors of the cube. conquer() solves one unit, the Coordinator runs
+// units in worker processes and stops them all at the first coloring.
+//
+// A split directory holds exactly one split: split_work() removes the files of an earlier one and
+// writes a manifest with the unit count and the graph fingerprint last, and the Coordinator only
+// runs a complete set of units that all match it.
+
+// Work unit file, text:
+//   3coloring-unit <index> <count> <fingerprint of the graph>
+//   <n> <m>, then m lines "v u"
+//   <k>, then k lines "v color": the fixed colors of the cube
+struct WorkUnit {
+  static constexpr char kMagic[] = "3coloring-unit";
+
+  struct Header {
+    size_t index = 0;
+    size_t count = 0;
+    uint64_t fingerprint = 0;
+  };
+
+  size_t index = 0;
+  size_t count = 0;
+  Graph graph;
+  Coloring fixed;
+
+  void save(const std::string& path) const {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+      throw std::runtime_error("Can't create file " + path);
+    }
+
+    GraphView view = graph.view();
+    file << kMagic << " " << index << " " << count << " " << view.fingerprint() << "\n";
+    file << view.n << " " << view.num_arcs() / 2 << "\n";
+    for (Vertex v = 0; v < view.n; ++v) {
+      for (auto u: view.adjacent(v)) {
+        if (v <= u) {
+          file << v << " " << u << "\n";
+        }
+      }
+    }
+    file << fixed.size() << "\n";
+    for (auto [v, color]: fixed) {
+      file << v << " " << color << "\n";
+    }
+    if (!file) {
+      throw std::runtime_error("Can't write file " + path);
+    }
+  }
+
+  static Header read_header(const std::string& path) {
+    std::ifstream file(path);
+    std::string magic;
+    Header header;
+    if (!(file >> magic >> header.index >> header.count >> header.fingerprint) || magic != kMagic) {
+      throw std::runtime_error("File " + path + " is not a work unit");
+    }
+    return header;
+  }
+
+  static WorkUnit load(const std::string& path) {
+    std::ifstream file(path);
+    std::string magic;
+    WorkUnit unit;
+    uint64_t fingerprint = 0;
+    size_t n = 0, m = 0;
+    if (!(file >> magic >> unit.index >> unit.count >> fingerprint >> n >> m) || magic != kMagic) {
+      throw std::runtime_error("File " + path + " is not a work unit");
+    }
+
+    std::vector<std::pair<Vertex, Vertex>> edges(m);
+    for (auto& [v, u]: edges) {
+      if (!(file >> v >> u) || v >= n || u >= n) {
+        throw std::runtime_error("Work unit " + path + " has a malformed edge");
+      }
+      if (u < v) {
+        std::swap(v, u);
+      }
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    unit.graph = Graph::from_sorted_edges(n, edges);
+    if (unit.graph.view().fingerprint() != fingerprint) {
+      throw std::runtime_error("Work unit " + path + " doesn't match its graph");
+    }
+
+    size_t k = 0;
+    file >> k;
+    for (size_t i = 0; i < k; ++i) {
+      Vertex v;
+      Color color;
+      if (!(file >> v >> color) || v >= n || color >= 3) {
+        throw std::runtime_error("Work unit " + path + " has a malformed fixed color");
+      }
+      unit.fixed[v] = color;
+    }
+    if (!file) {
+      throw std::runtime_error("Work unit " + path + " is truncated");
+    }
+    return unit;
+  }
+};
+
+inline std::string work_unit_name(size_t index) {
+  char name[32];
+  std::snprintf(name, sizeof(name), "unit-%06zu.txt", index);
+  return name;
+}
+
+// Manifest of a split directory, text: "3coloring-split <count> <fingerprint of the graph>".
+struct SplitManifest {
+  static constexpr char kMagic[] = "3coloring-split";
+  static constexpr char kName[] = "manifest.txt";
+
+  size_t count = 0;
+  uint64_t fingerprint = 0;
+
+  void save(const std::filesystem::path& directory) const {
+    auto path = (directory / kName).string();
+    std::ofstream file(path, std::ios::trunc);
+    file << kMagic << " " << count << " " << fingerprint << "\n";
+    if (!file) {
+      throw std::runtime_error("Can't write file " + path);
+    }
+  }
+
+  static SplitManifest load(const std::filesystem::path& directory) {
+    auto path = (directory / kName).string();
+    std::ifstream file(path);
+    std::string magic;
+    SplitManifest manifest;
+    if (!(file >> magic >> manifest.count >> manifest.fingerprint) || magic != kMagic) {
+      throw std::runtime_error("No complete split in " + directory.string() + ": " + path + " is missing or malformed");
+    }
+    return manifest;
+  }
+};
+
+// Whether a file name belongs to a split: units, their results, the manifest.
+inline bool is_split_file(const std::string& name) {
+  return name == SplitManifest::kName ||
+         (name.starts_with("unit-") && (name.ends_with(".txt") || name.ends_with(".result")));
+}
+
+// Writes the units of graph into directory and returns their number; 0 means the cubes already
+// refute the graph. The files of an earlier split in directory are removed first.
+inline size_t split_work(GraphView graph, size_t depth, const std::filesystem::path& directory) {
+  std::filesystem::create_directories(directory);
+  for (auto& entry: std::filesystem::directory_iterator(directory)) {
+    if (is_split_file(entry.path().filename().string())) {
+      std::filesystem::remove(entry.path());
+    }
+  }
+
+  Graph copy{graph.n, {graph.offsets.begin(), graph.offsets.end()},
+             {graph.neighbours.begin(), graph.neighbours.end()}};
+  auto cubes = ColoringSolver(copy.view()).cubes(depth);
+
+  WorkUnit unit;
+  unit.count = cubes.size();
+  unit.graph = std::move(copy);
+  for (size_t i = 0; i < cubes.size(); ++i) {
+    unit.index = i;
+    unit.fixed = std::move(cubes[i]);
+    unit.save(directory / work_unit_name(i));
+  }
+  // last: a split cut short leaves no manifest and can't be coordinated
+  SplitManifest{cubes.size(), graph.fingerprint()}.save(directory);
+  return cubes.size();
+}
+
+// A coloring of the unit's graph that keeps its fixed colors, or nullopt if there is none.
+//
+// The fixed colors are built into the graph: a palette triangle p0 p1 p2 is added and a fixed
+// vertex is joined to the two palette vertexes of the other colors, so any engine solves the unit
+// as a plain graph. The palette colors name the color permutation of the answer.
+inline std::optional<Coloring> conquer(const WorkUnit& unit) {
+  GraphView graph = unit.graph.view();
+  Vertex palette = graph.n;
+
+  std::vector<std::pair<Vertex, Vertex>> edges;
+  for (Vertex v = 0; v < graph.n; ++v) {
+    for (auto u: graph.adjacent(v)) {
+      if (v <= u) {
+        edges.emplace_back(v, u);
+      }
+    }
+  }
+  for (auto [v, color]: unit.fixed) {
+    for (Color other = 0; other < 3; ++other) {
+      if (other != color) {
+        edges.emplace_back(v, palette + other);
+      }
+    }
+  }
+  edges.emplace_back(palette, palette + 1);
+  edges.emplace_back(palette, palette + 2);
+  edges.emplace_back(palette + 1, palette + 2);
+  std::sort(edges.begin(), edges.end());
+
+  ColoringSolver solver(Graph::from_sorted_edges(graph.n + 3, edges));
+  if (!run_engine(solver, CostModel::load().choose(solver.features()))) {
+    return std::nullopt;
+  }
+
+  std::array<Color, 3> rename{};
+  for (Color color = 0; color < 3; ++color) {
+    rename[solver.coloring_.at(palette + color)] = color;
+  }
+  Coloring coloring;
+  for (Vertex v = 0; v < graph.n; ++v) {
+    coloring[v] = rename[solver.coloring_.at(v)];
+  }
+  return coloring;
+}
+
+// Runs `<program> conquer <unit> <result>` for every unit of a directory, at most `workers` at a
+// time, and kills the rest as soon as one finds a coloring. The exit codes follow SAT solvers.
+class Coordinator {
+ public:
+  static constexpr int kColorable = 10;
+  static constexpr int kNotColorable = 20;
+
+  Coordinator(std::string program, std::filesystem::path directory, size_t workers):
+      program_(std::move(program)), directory_(std::move(directory)), workers_(std::max<size_t>(workers, 1)) {}
+
+  // The coloring of the first unit that has one, nullopt if every unit is refuted.
+  // Throws if a worker fails or the units don't form the split of the manifest.
+  std::optional<Coloring> run() {
+    auto units = units_();
+
+    std::map<pid_t, std::filesystem::path> running;  // pid -> result file
+    std::optional<std::filesystem::path> found;
+    std::string failure;
+    size_t next = 0;
+
+    while (next < units.size() || !running.empty()) {
+      while (!found && failure.empty() && next < units.size() && running.size() < workers_) {
+        auto result = units[next];
+        result.replace_extension(".result");
+        running.emplace(spawn_(units[next], result), result);
+        ++next;
+      }
+      if (running.empty()) {
+        break;
+      }
+
+      int status = 0;
+      pid_t pid = ::waitpid(-1, &status, 0);
+      if (pid < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw std::runtime_error("waitpid failed: " + std::string(std::strerror(errno)));
+      }
+      auto it = running.find(pid);
+      if (it == running.end()) {
+        continue;
+      }
+
+      int code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+      if (code == kColorable && !found) {
+        found = it->second;
+      } else if (code != kNotColorable && !found && failure.empty()) {
+        failure = "Worker for " + it->second.string() + " failed";
+      }
+      running.erase(it);
+
+      if (found || !failure.empty()) {
+        for (auto& [other, _]: running) {
+          ::kill(other, SIGTERM);
+        }
+      }
+    }
+
+    if (found) {
+      return read_result_(*found);
+    }
+    if (!failure.empty()) {
+      throw std::runtime_error(failure);
+    }
+    return std::nullopt;
+  }
+
+  // Result file of conquer: "1" and "v: color" lines, or "0".
+  static void write_result(const std::filesystem::path& path, const std::optional<Coloring>& coloring) {
+    std::ofstream file(path, std::ios::trunc);
+    file << (coloring ? 1 : 0) << "\n";
+    if (coloring) {
+      for (auto [v, color]: *coloring) {
+        file << v << ": " << color << "\n";
+      }
+    }
+    if (!file) {
+      throw std::runtime_error("Can't write file " + path.string());
+    }
+  }
+
+ private:
+  pid_t spawn_(const std::filesystem::path& unit, const std::filesystem::path& result) const {
+    pid_t pid = ::fork();
+    if (pid < 0) {
+      throw std::runtime_error("fork failed: " + std::string(std::strerror(errno)));
+    }
+    if (pid == 0) {
+      std::string unit_path = unit.string(), result_path = result.string();
+      const char* argv[] = {program_.c_str(), "conquer", unit_path.c_str(), result_path.c_str(), nullptr};
+      ::execv(program_.c_str(), const_cast<char* const*>(argv));
+      ::_exit(127);
+    }
+    return pid;
+  }
+
+  // Units 0..count-1 of the manifest, each with its count and graph fingerprint, and no others.
+  std::vector<std::filesystem::path> units_() const {
+    auto manifest = SplitManifest::load(directory_);
+    size_t found = 0;
+    for (auto& entry: std::filesystem::directory_iterator(directory_)) {
+      auto name = entry.path().filename().string();
+      if (name.starts_with("unit-") && name.ends_with(".txt")) {
+        ++found;
+      }
+    }
+    if (found != manifest.count) {
+      throw std::runtime_error(directory_.string() + " holds " + std::to_string(found) + " units, its manifest " +
+                               std::to_string(manifest.count));
+    }
+
+    std::vector<std::filesystem::path> units;
+    for (size_t i = 0; i < manifest.count; ++i) {
+      auto path = directory_ / work_unit_name(i);
+      if (!std::filesystem::exists(path)) {
+        throw std::runtime_error("Work unit " + path.string() + " is missing");
+      }
+      auto header = WorkUnit::read_header(path.string());
+      if (header.index != i || header.count != manifest.count || header.fingerprint != manifest.fingerprint) {
+        throw std::runtime_error("Work unit " + path.string() + " belongs to another split");
+      }
+      units.push_back(std::move(path));
+    }
+    return units;
+  }
+
+  static Coloring read_result_(const std::filesystem::path& path) {
+    std::ifstream file(path);
+    int colorable = 0;
+    file >> colorable;
+    Coloring coloring;
+    Vertex v;
+    char colon;
+    Color color;
+    while (file >> v >> colon >> color) {
+      coloring[v] = color;
+    }
+    if (colorable != 1) {
+      throw std::runtime_error("Result " + path.string() + " has no coloring");
+    }
+    return coloring;
+  }
+
+  std::string program_;
+  std::filesystem::path directory_;
+  size_t workers_;
+};
+
+#endif //INC_3COLORING__CUBE_AND_CONQUER_HPP_
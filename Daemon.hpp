@@ -0,0 +1,490 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__DAEMON_HPP_
+#define INC_3COLORING__DAEMON_HPP_
+
+#include "Coloring.hpp"
+#include "Deadline.hpp"
+#include "Pool.hpp"
+#include "Selector.hpp"
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Wire format of the solver daemon, native byte order (the socket is local). One request per
+// connection; every message is a frame: uint64 payload length, then the payload.
+//   request   uint8 type
+//     kSolve     uint64 deadline_ms (0: none), uint64 n, uint64 num_arcs,
+//                uint64 offsets[n + 1], uint64 neighbours[num_arcs]  (CSR, as in GraphView)
+//     kStats, kShutdown: nothing more
+//   response  uint8 status
+//     kColorable     uint8 colors[n]
+//     kStats         JSON text of the counters
+namespace daemon_protocol {
+
+enum class Request : uint8_t {
+  kSolve = 0,
+  kStats = 1,
+  kShutdown = 2,
+};
+
+enum class Status : uint8_t {
+  kColorable = 0,
+  kNotColorable = 1,
+  kInvalidRequest = 2,
+  kBusy = 3,              // admission control: the queue is full, retry later
+  kDeadlineExceeded = 4,  // the deadline passed in the queue or during the search
+  kError = 5,
+  kOk = 6,                // stats and shutdown
+};
+
+inline const char* status_name(Status status) {
+  switch (status) {
+    case Status::kColorable:
+      return "colorable";
+    case Status::kNotColorable:
+      return "not colorable";
+    case Status::kInvalidRequest:
+      return "invalid request";
+    case Status::kBusy:
+      return "busy";
+    case Status::kDeadlineExceeded:
+      return "deadline exceeded";
+    case Status::kError:
+      return "error";
+    case Status::kOk:
+      return "ok";
+  }
+  return "unknown";
+}
+
+inline bool read_all(int fd, void* data, size_t size) {
+  auto* bytes = static_cast<char*>(data);
+  while (size > 0) {
+    ssize_t got = ::recv(fd, bytes, size, 0);
+    if (got < 0 && errno == EINTR) {
+      continue;
+    }
+    if (got <= 0) {
+      return false;
+    }
+    bytes += got;
+    size -= static_cast<size_t>(got);
+  }
+  return true;
+}
+
+inline bool write_all(int fd, const void* data, size_t size) {
+  auto* bytes = static_cast<const char*>(data);
+  while (size > 0) {
+    ssize_t sent = ::send(fd, bytes, size, MSG_NOSIGNAL);
+    if (sent < 0 && errno == EINTR) {
+      continue;
+    }
+    if (sent <= 0) {
+      return false;
+    }
+    bytes += sent;
+    size -= static_cast<size_t>(sent);
+  }
+  return true;
+}
+
+inline bool write_frame(int fd, const std::string& payload) {
+  uint64_t size = payload.size();
+  return write_all(fd, &size, sizeof(size)) && write_all(fd, payload.data(), payload.size());
+}
+
+// Reads one frame of at most max_size bytes.
+inline bool read_frame(int fd, std::string& payload, size_t max_size) {
+  uint64_t size = 0;
+  if (!read_all(fd, &size, sizeof(size)) || size > max_size) {
+    return false;
+  }
+  payload.resize(size);
+  return read_all(fd, payload.data(), size);
+}
+
+template<typename T>
+void append(std::string& payload, const T& value) {
+  payload.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+inline sockaddr_un socket_address(const std::string& path) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    throw std::runtime_error("Socket path is too long: " + path);
+  }
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+  return address;
+}
+
+inline int connect_to(const std::string& path) {
+  int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    throw std::runtime_error("Can't create socket: " + std::string(std::strerror(errno)));
+  }
+  auto address = socket_address(path);
+  if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+    int error = errno;
+    ::close(fd);
+    throw std::runtime_error("Can't connect to " + path + ": " + std::strerror(error));
+  }
+  return fd;
+}
+
+} // namespace daemon_protocol
+
+// Long-running solver behind a Unix domain socket, so that callers with many small graphs pay
+// neither the process start nor the cold allocator of a fresh 3coloring run.
+//
+// One acceptor thread reads the requests and answers stats and shutdown itself; solves go to a
+// bounded queue served by a fixed pool of worker threads, started and given their pool arenas up
+// front. A solve that finds the queue full is answered kBusy at once. Deadlines are cooperative:
+// the searches call Deadline::check() and unwind with DeadlineExceeded.
+class SolverDaemon {
+ public:
+  using Status = daemon_protocol::Status;
+  using Clock = Deadline::Clock;
+
+  struct Options {
+    std::string socket_path;
+    size_t workers = std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+    size_t queue_limit = 64;              // queued solves, not counting the running ones
+    size_t arena_bytes = 8 << 20;         // NodePool chunks reserved per worker at start
+    size_t max_request_bytes = 1ull << 30;
+    std::chrono::milliseconds read_timeout{5000};  // a stalled client holds the acceptor this long
+  };
+
+  explicit SolverDaemon(Options options):
+      options_(std::move(options)), model_(CostModel::load()) {
+    options_.workers = std::max<size_t>(options_.workers, 1);
+  }
+
+  SolverDaemon(const SolverDaemon&) = delete;
+  SolverDaemon& operator=(const SolverDaemon&) = delete;
+
+  // Serves until a kShutdown request; the queued solves are finished before it returns.
+  void serve() {
+    listen_();
+    NodePool::reserve(options_.arena_bytes * options_.workers);
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < options_.workers; ++i) {
+      workers.emplace_back([this] { work_(); });
+    }
+
+    accept_();
+
+    {
+      std::lock_guard lock(mutex_);
+      stopping_ = true;
+    }
+    ready_.notify_all();
+    for (auto& worker: workers) {
+      worker.join();
+    }
+    ::close(listen_fd_);
+    ::unlink(options_.socket_path.c_str());
+  }
+
+  // JSON counters; latency_us[i] counts the solves that took [2^i, 2^(i+1)) microseconds from
+  // arrival to reply.
+  std::string stats() const {
+    std::ostringstream out;
+    size_t queue_depth;
+    {
+      std::lock_guard lock(mutex_);
+      queue_depth = queue_.size();
+    }
+    out << "{\"queue_depth\":" << queue_depth
+        << ",\"in_flight\":" << in_flight_.load()
+        << ",\"workers\":" << options_.workers
+        << ",\"queue_limit\":" << options_.queue_limit
+        << ",\"accepted\":" << accepted_.load()
+        << ",\"rejected\":" << rejected_.load()
+        << ",\"completed\":" << completed_.load()
+        << ",\"deadline_exceeded\":" << deadline_exceeded_.load()
+        << ",\"pool_chunk_bytes\":" << NodePool::stats().chunk_bytes
+        << ",\"latency_us\":[";
+    for (size_t i = 0; i < latency_.size(); ++i) {
+      out << (i == 0 ? "" : ",") << latency_[i].load();
+    }
+    out << "]}";
+    return out.str();
+  }
+
+ private:
+  static constexpr size_t kLatencyBuckets = 32;
+
+  struct Job {
+    int fd = -1;
+    size_t n = 0;
+    std::vector<size_t> offsets;
+    std::vector<Vertex> neighbours;
+    std::optional<Clock::time_point> deadline;
+    Clock::time_point arrival;
+  };
+
+  void listen_() {
+    auto address = daemon_protocol::socket_address(options_.socket_path);
+
+    // a leftover socket file of a dead daemon is replaced, a live daemon is not
+    int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    bool live = probe >= 0 && ::connect(probe, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+    ::close(probe);
+    if (live) {
+      throw std::runtime_error("A daemon is already listening on " + options_.socket_path);
+    }
+    ::unlink(options_.socket_path.c_str());
+
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+      throw std::runtime_error("Can't create socket: " + std::string(std::strerror(errno)));
+    }
+    // local only: the socket is accessible to the owner alone
+    mode_t mask = ::umask(0177);
+    int bound = ::bind(listen_fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+    int error = errno;
+    ::umask(mask);
+    if (bound != 0 || ::listen(listen_fd_, SOMAXCONN) != 0) {
+      ::close(listen_fd_);
+      throw std::runtime_error("Can't listen on " + options_.socket_path + ": " + std::strerror(error));
+    }
+  }
+
+  void accept_() {
+    timeval timeout{};
+    timeout.tv_sec = options_.read_timeout.count() / 1000;
+    timeout.tv_usec = options_.read_timeout.count() % 1000 * 1000;
+
+    while (true) {
+      int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+      if (fd < 0) {
+        if (errno == EINTR || errno == ECONNABORTED) {
+          continue;
+        }
+        throw std::runtime_error("Can't accept: " + std::string(std::strerror(errno)));
+      }
+      ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+      auto arrival = Clock::now();
+      std::string payload;
+      if (!daemon_protocol::read_frame(fd, payload, options_.max_request_bytes) || payload.empty()) {
+        reply_(fd, Status::kInvalidRequest);
+        continue;
+      }
+
+      auto type = static_cast<daemon_protocol::Request>(payload[0]);
+      if (type == daemon_protocol::Request::kStats) {
+        reply_(fd, Status::kOk, stats());
+      } else if (type == daemon_protocol::Request::kShutdown) {
+        reply_(fd, Status::kOk);
+        return;
+      } else if (type == daemon_protocol::Request::kSolve) {
+        submit_(fd, payload, arrival);
+      } else {
+        reply_(fd, Status::kInvalidRequest);
+      }
+    }
+  }
+
+  void submit_(int fd, const std::string& payload, Clock::time_point arrival) {
+    uint64_t header[3];  // deadline_ms, n, num_arcs
+    if (payload.size() < 1 + sizeof(header)) {
+      reply_(fd, Status::kInvalidRequest);
+      return;
+    }
+    std::memcpy(header, payload.data() + 1, sizeof(header));
+    auto [deadline_ms, n, num_arcs] = header;
+    size_t words = payload.size() / sizeof(uint64_t);
+    if (n >= words || num_arcs >= words ||
+        payload.size() != 1 + sizeof(header) + (n + 1 + num_arcs) * sizeof(uint64_t)) {
+      reply_(fd, Status::kInvalidRequest);
+      return;
+    }
+
+    std::unique_lock lock(mutex_);
+    if (queue_.size() >= options_.queue_limit) {
+      lock.unlock();
+      ++rejected_;
+      reply_(fd, Status::kBusy);
+      return;
+    }
+    lock.unlock();
+
+    Job job;
+    job.fd = fd;
+    job.n = n;
+    job.offsets.resize(n + 1);
+    job.neighbours.resize(num_arcs);
+    const char* arrays = payload.data() + 1 + sizeof(header);
+    std::memcpy(job.offsets.data(), arrays, job.offsets.size() * sizeof(uint64_t));
+    std::memcpy(job.neighbours.data(), arrays + job.offsets.size() * sizeof(uint64_t),
+                job.neighbours.size() * sizeof(uint64_t));
+    if (deadline_ms != 0) {
+      job.deadline = arrival + std::chrono::milliseconds(deadline_ms);
+    }
+    job.arrival = arrival;
+
+    ++accepted_;
+    lock.lock();
+    queue_.push_back(std::move(job));
+    lock.unlock();
+    ready_.notify_one();
+  }
+
+  void work_() {
+    while (true) {
+      std::unique_lock lock(mutex_);
+      ready_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      Job job = std::move(queue_.front());
+      queue_.pop_front();
+      ++in_flight_;
+      lock.unlock();
+
+      std::string colors;
+      Status status = solve_(job, colors);
+      if (status == Status::kDeadlineExceeded) {
+        ++deadline_exceeded_;
+      }
+      reply_(job.fd, status, colors);
+
+      auto latency = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - job.arrival);
+      size_t bucket = std::bit_width(static_cast<uint64_t>(std::max<int64_t>(latency.count(), 1))) - 1;
+      ++latency_[std::min(bucket, kLatencyBuckets - 1)];
+      ++completed_;
+      --in_flight_;
+    }
+  }
+
+  Status solve_(const Job& job, std::string& colors) const {
+    if (job.deadline && Clock::now() >= *job.deadline) {
+      return Status::kDeadlineExceeded;
+    }
+    GraphView graph{job.n, job.offsets, job.neighbours};
+    if (!graph.is_valid()) {
+      return Status::kInvalidRequest;
+    }
+
+    try {
+      DeadlineScope scope(job.deadline);
+      ColoringSolver solver(graph);
+      if (!run_engine(solver, model_.choose(solver.features()))) {
+        return Status::kNotColorable;
+      }
+      colors.assign(job.n, 0);
+      for (auto [v, color]: solver.coloring_) {
+        colors[v] = static_cast<char>(color);
+      }
+      return Status::kColorable;
+    } catch (const DeadlineExceeded&) {
+      return Status::kDeadlineExceeded;
+    } catch (const std::exception&) {
+      return Status::kError;
+    }
+  }
+
+  // Sends the response and closes the connection.
+  static void reply_(int fd, Status status, const std::string& body = "") {
+    std::string payload(1, static_cast<char>(status));
+    payload += body;
+    daemon_protocol::write_frame(fd, payload);
+    ::close(fd);
+  }
+
+  Options options_;
+  CostModel model_;
+  int listen_fd_ = -1;
+
+  mutable std::mutex mutex_;
+  std::condition_variable ready_;
+  std::deque<Job> queue_;
+  bool stopping_ = false;
+
+  std::atomic<size_t> in_flight_ = 0;
+  std::atomic<size_t> accepted_ = 0;
+  std::atomic<size_t> rejected_ = 0;
+  std::atomic<size_t> completed_ = 0;
+  std::atomic<size_t> deadline_exceeded_ = 0;
+  std::array<std::atomic<size_t>, kLatencyBuckets> latency_{};
+};
+
+// Client side of the protocol, one connection per call.
+class DaemonClient {
+ public:
+  using Status = daemon_protocol::Status;
+
+  struct Result {
+    Status status = Status::kError;
+    std::vector<Color> colors;  // when kColorable
+  };
+
+  explicit DaemonClient(std::string socket_path): socket_path_(std::move(socket_path)) {}
+
+  Result solve(GraphView graph, std::chrono::milliseconds deadline = {}) const {
+    std::string payload(1, static_cast<char>(daemon_protocol::Request::kSolve));
+    daemon_protocol::append(payload, static_cast<uint64_t>(deadline.count()));
+    daemon_protocol::append(payload, static_cast<uint64_t>(graph.n));
+    daemon_protocol::append(payload, static_cast<uint64_t>(graph.num_arcs()));
+    payload.append(reinterpret_cast<const char*>(graph.offsets.data()), graph.offsets.size_bytes());
+    payload.append(reinterpret_cast<const char*>(graph.neighbours.data()), graph.neighbours.size_bytes());
+
+    auto response = call_(payload);
+    Result result;
+    result.status = static_cast<Status>(response[0]);
+    if (result.status == Status::kColorable) {
+      if (response.size() != graph.n + 1) {
+        throw std::runtime_error("Malformed daemon response");
+      }
+      result.colors.assign(response.begin() + 1, response.end());
+    }
+    return result;
+  }
+
+  std::string stats() const {
+    return call_(std::string(1, static_cast<char>(daemon_protocol::Request::kStats))).substr(1);
+  }
+
+  void shutdown() const {
+    call_(std::string(1, static_cast<char>(daemon_protocol::Request::kShutdown)));
+  }
+
+ private:
+  std::string call_(const std::string& request) const {
+    int fd = daemon_protocol::connect_to(socket_path_);
+    std::string response;
+    bool ok = daemon_protocol::write_frame(fd, request) &&
+              daemon_protocol::read_frame(fd, response, std::numeric_limits<uint64_t>::max());
+    ::close(fd);
+    if (!ok || response.empty()) {
+      throw std::runtime_error("No response from the daemon at " + socket_path_);
+    }
+    return response;
+  }
+
+  std::string socket_path_;
+};
+
+#endif //INC_3COLORING__DAEMON_HPP_
@@ -0,0 +1,66 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__DEADLINE_HPP_
+#define INC_3COLORING__DEADLINE_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+
+class DeadlineExceeded: public std::runtime_error {
+ public:
+  DeadlineExceeded(): std::runtime_error("Deadline exceeded") {}
+};
+
+// Cooperative deadline of the searches running on the calling thread. The searches call check()
+// at every branch; past the deadline it throws DeadlineExceeded, which unwinds the search.
+class Deadline {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  static void set(std::optional<Clock::time_point> deadline) {
+    state_() = {deadline, 0};
+  }
+  static void clear() {
+    set(std::nullopt);
+  }
+
+  static void check() {
+    auto& state = state_();
+    // the clock is read once per kStride checks
+    if (state.deadline && ++state.calls % kStride == 0 && Clock::now() >= *state.deadline) {
+      throw DeadlineExceeded();
+    }
+  }
+
+ private:
+  static constexpr uint32_t kStride = 64;
+
+  struct State {
+    std::optional<Clock::time_point> deadline;
+    uint32_t calls = 0;
+  };
+
+  static State& state_() {
+    thread_local State state;
+    return state;
+  }
+};
+
+// Sets the deadline of the calling thread for its lifetime.
+class DeadlineScope {
+ public:
+  explicit DeadlineScope(std::optional<Deadline::Clock::time_point> deadline) {
+    Deadline::set(deadline);
+  }
+  DeadlineScope(const DeadlineScope&) = delete;
+  DeadlineScope& operator=(const DeadlineScope&) = delete;
+  ~DeadlineScope() {
+    Deadline::clear();
+  }
+};
+
+#endif //INC_3COLORING__DEADLINE_HPP_
@@ -0,0 +1,126 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__ENUMERATION_HPP_
+#define INC_3COLORING__ENUMERATION_HPP_
+
+#include "Graph.hpp"
+#include "Generator.hpp"
+#include <array>
+
+struct EnumerationOptions {
+  bool up_to_permutation = false;  // one coloring per orbit of the color permutations
+  size_t limit = 0;                // stop after this many colorings, 0 means all of them
+};
+
+// Every 3-coloring of the graph, produced lazily by a backtracking search with forward checking.
+// The search keeps only the current partial coloring, O(n + m) memory, and continues from it when
+// the next coloring is requested. The graph must outlive the generator.
+//
+// Vertexes are visited in BFS order from the highest degree vertex of each component, so most of
+// them already have colored neighbours. With up_to_permutation the colors are restricted-growth
+// over that order: a vertex takes at most one color more than the ones used before it.
+inline Generator<Coloring> enumerate_colorings(GraphView graph, EnumerationOptions options = {}) {
+  constexpr size_t kColors = 3;
+  constexpr Color kNone = kColors;
+
+  for (Vertex v = 0; v < graph.n; ++v) {
+    auto adjacent = graph.adjacent(v);
+    if (std::binary_search(adjacent.begin(), adjacent.end(), v)) {
+      co_return;
+    }
+  }
+
+  std::vector<Vertex> starts(graph.n);
+  for (Vertex v = 0; v < graph.n; ++v) {
+    starts[v] = v;
+  }
+  std::stable_sort(starts.begin(), starts.end(), [&](Vertex v, Vertex u) {
+    return graph.degree(v) > graph.degree(u);
+  });
+
+  std::vector<Vertex> order;
+  std::vector<bool> visited(graph.n, false);
+  for (auto start: starts) {
+    if (visited[start]) {
+      continue;
+    }
+    visited[start] = true;
+    order.push_back(start);
+    for (size_t head = order.size() - 1; head < order.size(); ++head) {
+      for (auto u: graph.adjacent(order[head])) {
+        if (!visited[u]) {
+          visited[u] = true;
+          order.push_back(u);
+        }
+      }
+    }
+  }
+
+  std::vector<Color> colors(graph.n, kNone);
+  std::vector<std::array<uint32_t, kColors>> blocked(graph.n, {0, 0, 0});  // colored neighbours per color
+  std::vector<Color> next(graph.n + 1, 0);   // next color to try at each depth
+  std::vector<size_t> used(graph.n + 1, 0);  // number of colors used before each depth
+  size_t emitted = 0;
+
+  auto assign = [&](Vertex v, Color color) {
+    colors[v] = color;
+    bool alive = true;
+    for (auto u: graph.adjacent(v)) {
+      auto& counts = blocked[u];
+      ++counts[color];
+      alive &= colors[u] != kNone || counts[0] == 0 || counts[1] == 0 || counts[2] == 0;
+    }
+    return alive;
+  };
+  auto unassign = [&](Vertex v) {
+    for (auto u: graph.adjacent(v)) {
+      --blocked[u][colors[v]];
+    }
+    colors[v] = kNone;
+  };
+
+  size_t depth = 0;
+  while (true) {
+    if (depth == graph.n) {
+      Coloring coloring;
+      for (Vertex v = 0; v < graph.n; ++v) {
+        coloring.insert(coloring.end(), {v, colors[v]});
+      }
+      co_yield coloring;
+
+      if (++emitted == options.limit || depth == 0) {
+        co_return;
+      }
+      unassign(order[--depth]);
+      continue;
+    }
+
+    Vertex v = order[depth];
+    Color last = options.up_to_permutation ? std::min(used[depth], kColors - 1) : kColors - 1;
+    bool placed = false;
+    for (Color color = next[depth]; color <= last && !placed; ++color) {
+      if (blocked[v][color] != 0) {
+        continue;
+      }
+      next[depth] = color + 1;
+      if (assign(v, color)) {
+        placed = true;
+      } else {
+        unassign(v);
+      }
+    }
+
+    if (placed) {
+      used[depth + 1] = std::max(used[depth], colors[v] + 1);
+      next[++depth] = 0;
+    } else if (depth == 0) {
+      co_return;
+    } else {
+      unassign(order[--depth]);
+    }
+  }
+}
+
+#endif //INC_3COLORING__ENUMERATION_HPP_
@@ -0,0 +1,333 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__FAST_PATHS_HPP_
+#define INC_3COLORING__FAST_PATHS_HPP_
+
+#include "Graph.hpp"
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <optional>
+#include <set>
+#include <vector>
+
+// Classes of graphs with a polynomial answer, recognized in O(n + m) before the search.
+enum class FastPath {
+  kBipartite,   // two colors
+  kMaxDegree3,  // Brooks: colorable unless a component is K4
+  kChordal,     // colorable iff the largest clique has at most 3 vertexes
+};
+
+inline const char* fast_path_name(FastPath path) {
+  switch (path) {
+    case FastPath::kBipartite:
+      return "bipartite";
+    case FastPath::kMaxDegree3:
+      return "max_degree_3";
+    case FastPath::kChordal:
+      return "chordal";
+  }
+  return "";
+}
+
+struct FastPathAnswer {
+  FastPath path = FastPath::kBipartite;
+  bool colorable = false;
+  Coloring coloring;  // of every vertex, when colorable
+};
+
+class FastPaths {
+ public:
+  struct Stats {
+    size_t bipartite = 0;
+    size_t max_degree_3 = 0;
+    size_t chordal = 0;
+  };
+
+  // The answer for the graph if it falls into one of the classes, nullopt otherwise.
+  static std::optional<FastPathAnswer> solve(const std::map<Vertex, std::set<Vertex>>& edges) {
+    Compact graph(edges);
+    std::vector<Color> colors;
+    std::optional<FastPathAnswer> answer;
+
+    if (two_color_(graph, colors)) {
+      answer = FastPathAnswer{FastPath::kBipartite, true, {}};
+    } else if (auto colorable = max_degree_3_(graph, colors)) {
+      answer = FastPathAnswer{FastPath::kMaxDegree3, *colorable, {}};
+    } else if (auto colorable = chordal_(graph, colors)) {
+      answer = FastPathAnswer{FastPath::kChordal, *colorable, {}};
+    }
+    if (!answer) {
+      return std::nullopt;
+    }
+
+    counter_(answer->path).fetch_add(1, std::memory_order_relaxed);
+    if (answer->colorable) {
+      for (size_t i = 0; i < graph.labels.size(); ++i) {
+        answer->coloring.insert(answer->coloring.end(), {graph.labels[i], colors[i]});
+      }
+    }
+    return answer;
+  }
+
+  // How many times each path answered, process-wide.
+  static Stats stats() {
+    return {counter_(FastPath::kBipartite).load(std::memory_order_relaxed),
+            counter_(FastPath::kMaxDegree3).load(std::memory_order_relaxed),
+            counter_(FastPath::kChordal).load(std::memory_order_relaxed)};
+  }
+
+ private:
+  static constexpr Color kNone = 3;
+
+  // Vertexes renamed to 0..n-1 in increasing order.
+  struct Compact {
+    explicit Compact(const std::map<Vertex, std::set<Vertex>>& edges) {
+      std::map<Vertex, size_t> index;
+      for (auto& [v, _]: edges) {
+        index.emplace_hint(index.end(), v, labels.size());
+        labels.push_back(v);
+      }
+      adjacent.resize(labels.size());
+      for (auto& [v, neighbours]: edges) {
+        auto& list = adjacent[index.at(v)];
+        for (auto u: neighbours) {
+          list.push_back(index.at(u));
+        }
+      }
+    }
+
+    size_t size() const {
+      return labels.size();
+    }
+
+    std::vector<Vertex> labels;
+    std::vector<std::vector<size_t>> adjacent;
+  };
+
+  static std::atomic<size_t>& counter_(FastPath path) {
+    static std::atomic<size_t> counters[3];
+    return counters[static_cast<size_t>(path)];
+  }
+
+  // Smallest color of no colored neighbour, kNone if all three are taken.
+  static Color free_color_(const Compact& graph, const std::vector<Color>& colors, size_t v) {
+    bool taken[3] = {false, false, false};
+    for (auto u: graph.adjacent[v]) {
+      if (colors[u] != kNone) {
+        taken[colors[u]] = true;
+      }
+    }
+    for (Color color = 0; color < 3; ++color) {
+      if (!taken[color]) {
+        return color;
+      }
+    }
+    return kNone;
+  }
+
+  // Greedy in the given order; false if a vertex finds no free color.
+  static bool greedy_(const Compact& graph, std::vector<Color>& colors, const std::vector<size_t>& order) {
+    for (auto v: order) {
+      colors[v] = free_color_(graph, colors, v);
+      if (colors[v] == kNone) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Vertexes reachable from start through vertexes not yet seen with this stamp, in BFS order;
+  // they are seen with it afterwards.
+  static std::vector<size_t> bfs_(const Compact& graph, size_t start, std::vector<size_t>& seen, size_t stamp) {
+    std::vector<size_t> order = {start};
+    seen[start] = stamp;
+    for (size_t head = 0; head < order.size(); ++head) {
+      for (auto u: graph.adjacent[order[head]]) {
+        if (seen[u] != stamp) {
+          seen[u] = stamp;
+          order.push_back(u);
+        }
+      }
+    }
+    return order;
+  }
+
+  static bool two_color_(const Compact& graph, std::vector<Color>& colors) {
+    colors.assign(graph.size(), kNone);
+    std::vector<size_t> seen(graph.size(), 0);
+    for (size_t start = 0; start < graph.size(); ++start) {
+      if (colors[start] != kNone) {
+        continue;
+      }
+      colors[start] = 0;
+      for (auto v: bfs_(graph, start, seen, 1)) {
+        for (auto u: graph.adjacent[v]) {
+          if (colors[u] == kNone) {
+            colors[u] = 1 - colors[v];
+          } else if (colors[u] == colors[v]) {
+            return false;
+          }
+        }
+      }
+    }
+    return true;
+  }
+
+  // Brooks' theorem for maximum degree 3, per connected component, following Lovasz's proof:
+  //  - a vertex r of degree < 3: color by decreasing BFS distance from r, every vertex but r still
+  //    has its uncolored parent then, and r has at most two neighbours;
+  //  - cubic: a vertex v with non-adjacent neighbours u, w such that the rest stays connected;
+  //    u and w share a color, the rest goes by decreasing distance from v, and v sees two colors.
+  // nullopt if the degree is larger or no such v is found in a few tries (the search decides then).
+  static std::optional<bool> max_degree_3_(const Compact& graph, std::vector<Color>& colors) {
+    constexpr size_t kTries = 32;
+    for (auto& list: graph.adjacent) {
+      if (list.size() > 3) {
+        return std::nullopt;
+      }
+    }
+
+    colors.assign(graph.size(), kNone);
+    std::vector<size_t> seen(graph.size(), 0), component_of(graph.size(), 0);
+    size_t stamp = 0;
+    for (size_t start = 0; start < graph.size(); ++start) {
+      if (component_of[start] != 0) {
+        continue;
+      }
+      auto component = bfs_(graph, start, component_of, 1);
+
+      auto low = std::find_if(component.begin(), component.end(), [&](size_t v) {
+        return graph.adjacent[v].size() < 3;
+      });
+      if (low != component.end()) {
+        auto order = bfs_(graph, *low, seen, ++stamp);
+        std::reverse(order.begin(), order.end());
+        if (!greedy_(graph, colors, order)) {
+          return std::nullopt;
+        }
+        continue;
+      }
+      if (component.size() == 4) {
+        return false;  // cubic on 4 vertexes: K4
+      }
+
+      bool colored = false;
+      size_t tries = 0;
+      for (auto v: component) {
+        auto& around = graph.adjacent[v];
+        for (size_t i = 0; i < around.size() && !colored && tries < kTries; ++i) {
+          for (size_t j = i + 1; j < around.size() && !colored && tries < kTries; ++j) {
+            size_t u = around[i], w = around[j];
+            auto& of_u = graph.adjacent[u];
+            if (std::find(of_u.begin(), of_u.end(), w) != of_u.end()) {
+              continue;
+            }
+
+            ++tries;
+            seen[u] = seen[w] = ++stamp;
+            auto order = bfs_(graph, v, seen, stamp);
+            if (order.size() + 2 != component.size()) {
+              continue;
+            }
+
+            colors[u] = colors[w] = 0;
+            std::reverse(order.begin(), order.end());
+            if (!greedy_(graph, colors, order)) {
+              return std::nullopt;
+            }
+            colored = true;
+          }
+        }
+        if (colored || tries >= kTries) {
+          break;
+        }
+      }
+      if (!colored) {
+        return std::nullopt;
+      }
+    }
+    return true;
+  }
+
+  // Maximum cardinality search gives a perfect elimination ordering, reversed, iff the graph is
+  // chordal (Tarjan and Yannakakis). The neighbours visited before a vertex form a clique then, so
+  // the clique number is one more than the largest such set and greedy coloring in visit order
+  // uses no more colors than that.
+  static std::optional<bool> chordal_(const Compact& graph, std::vector<Color>& colors) {
+    size_t n = graph.size();
+    std::vector<size_t> order, position(n, n), weight(n, 0);
+    std::vector<std::vector<size_t>> buckets(1);
+    for (size_t v = 0; v < n; ++v) {
+      buckets[0].push_back(v);
+    }
+
+    size_t top = 0;
+    while (order.size() < n) {
+      while (buckets[top].empty()) {
+        --top;
+      }
+      size_t v = buckets[top].back();
+      buckets[top].pop_back();
+      if (position[v] != n || weight[v] != top) {
+        continue;  // stale entry
+      }
+
+      position[v] = order.size();
+      order.push_back(v);
+      for (auto u: graph.adjacent[v]) {
+        if (position[u] == n) {
+          if (++weight[u] >= buckets.size()) {
+            buckets.resize(weight[u] + 1);
+          }
+          buckets[weight[u]].push_back(u);
+          top = std::max(top, weight[u]);
+        }
+      }
+    }
+
+    // for each v its earlier neighbours but the latest one, p, must be adjacent to p
+    std::vector<std::vector<size_t>> required(n);
+    size_t clique = 1;
+    for (auto v: order) {
+      std::optional<size_t> parent;
+      size_t earlier = 0;
+      for (auto u: graph.adjacent[v]) {
+        if (position[u] < position[v]) {
+          ++earlier;
+          if (!parent || position[u] > position[*parent]) {
+            parent = u;
+          }
+        }
+      }
+      clique = std::max(clique, earlier + 1);
+      for (auto u: graph.adjacent[v]) {
+        if (position[u] < position[v] && u != *parent) {
+          required[*parent].push_back(u);
+        }
+      }
+    }
+
+    std::vector<size_t> mark(n, n);
+    for (size_t p = 0; p < n; ++p) {
+      for (auto u: graph.adjacent[p]) {
+        mark[u] = p;
+      }
+      for (auto u: required[p]) {
+        if (mark[u] != p) {
+          return std::nullopt;
+        }
+      }
+    }
+
+    if (clique > 3) {
+      return false;
+    }
+    colors.assign(n, kNone);
+    return greedy_(graph, colors, order);
+  }
+};
+
+#endif //INC_3COLORING__FAST_PATHS_HPP_
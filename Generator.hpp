@@ -0,0 +1,137 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__GENERATOR_HPP_
+#define INC_3COLORING__GENERATOR_HPP_
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <utility>
+
+// Lazy sequence produced by a coroutine that co_yields values of T. The coroutine runs only when
+// the next value is requested, so a search yielding its results keeps its state between them.
+// The yielded value is valid until the next one is requested.
+template<class T>
+class Generator {
+ public:
+  struct promise_type {
+    const T* value = nullptr;
+    std::exception_ptr exception;
+
+    Generator get_return_object() {
+      return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() noexcept {
+      return {};
+    }
+    std::suspend_always final_suspend() noexcept {
+      return {};
+    }
+    // a temporary lives until the end of the co_yield expression, that is, until resumption
+    std::suspend_always yield_value(const T& yielded) noexcept {
+      value = std::addressof(yielded);
+      return {};
+    }
+    void return_void() {}
+    void unhandled_exception() {
+      exception = std::current_exception();
+    }
+  };
+
+  class iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+
+    iterator() = default;
+    explicit iterator(Generator* generator): generator_(generator) {}
+
+    const T& operator*() const {
+      return *generator_->handle_.promise().value;
+    }
+    const T* operator->() const {
+      return generator_->handle_.promise().value;
+    }
+
+    iterator& operator++() {
+      generator_->advance_();
+      return *this;
+    }
+    void operator++(int) {
+      ++*this;
+    }
+
+    bool operator==(std::default_sentinel_t) const {
+      return generator_ == nullptr || !generator_->handle_ || generator_->handle_.done();
+    }
+
+   private:
+    Generator* generator_ = nullptr;
+  };
+
+  Generator(Generator&& other) noexcept: handle_(std::exchange(other.handle_, {})), started_(other.started_) {}
+  Generator& operator=(Generator&& other) noexcept {
+    if (this != &other) {
+      destroy_();
+      handle_ = std::exchange(other.handle_, {});
+      started_ = other.started_;
+    }
+    return *this;
+  }
+  Generator(const Generator&) = delete;
+  Generator& operator=(const Generator&) = delete;
+
+  ~Generator() {
+    destroy_();
+  }
+
+  // Runs the coroutine up to the first value.
+  iterator begin() {
+    if (!started_) {
+      advance_();
+    }
+    return iterator(this);
+  }
+  std::default_sentinel_t end() const {
+    return {};
+  }
+
+  // The next value, nullopt when the coroutine has finished.
+  std::optional<T> next() {
+    advance_();
+    if (!handle_ || handle_.done()) {
+      return std::nullopt;
+    }
+    return *handle_.promise().value;
+  }
+
+ private:
+  explicit Generator(std::coroutine_handle<promise_type> handle): handle_(handle) {}
+
+  void advance_() {
+    started_ = true;
+    if (!handle_ || handle_.done()) {
+      return;
+    }
+    handle_.resume();
+    if (handle_.promise().exception) {
+      std::rethrow_exception(std::exchange(handle_.promise().exception, nullptr));
+    }
+  }
+
+  void destroy_() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  std::coroutine_handle<promise_type> handle_;
+  bool started_ = false;
+};
+
+#endif //INC_3COLORING__GENERATOR_HPP_
@@ -0,0 +1,115 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__GRAPH_HPP_
+#define INC_3COLORING__GRAPH_HPP_
+
+#include "SSS.hpp"
+#include <span>
+#include <vector>
+
+using Coloring = std::map<Vertex, Color>;
+
+// Read-only CSR view: neighbours of v are neighbours[offsets[v] .. offsets[v + 1]).
+// Does not own the arrays, so it can point into a Graph or into mapped memory.
+struct GraphView {
+  size_t n = 0;
+  std::span<const size_t> offsets;
+  std::span<const Vertex> neighbours;
+
+  size_t degree(Vertex v) const {
+    return offsets[v + 1] - offsets[v];
+  }
+  std::span<const Vertex> adjacent(Vertex v) const {
+    return neighbours.subspan(offsets[v], degree(v));
+  }
+  size_t num_arcs() const {
+    return neighbours.size();
+  }
+
+  // FNV-1a of the arrays: ties files written for a graph (checkpoints, work units) to it.
+  uint64_t fingerprint() const {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&](uint64_t value) {
+      hash = (hash ^ value) * 1099511628211ull;
+    };
+    mix(n);
+    for (auto offset: offsets) {
+      mix(offset);
+    }
+    for (auto v: neighbours) {
+      mix(v);
+    }
+    return hash;
+  }
+
+  // Checks arrays that come from outside: consistent offsets, sorted neighbour lists in range,
+  // no self-loops, symmetric adjacency.
+  bool is_valid() const {
+    if (offsets.size() != n + 1 || offsets[0] != 0 || offsets[n] != neighbours.size()) {
+      return false;
+    }
+    for (Vertex v = 0; v < n; ++v) {
+      if (offsets[v] > offsets[v + 1]) {
+        return false;
+      }
+    }
+
+    for (Vertex v = 0; v < n; ++v) {
+      auto around = adjacent(v);
+      for (size_t i = 0; i < around.size(); ++i) {
+        Vertex u = around[i];
+        if (u >= n || u == v || (i > 0 && around[i - 1] >= u)) {
+          return false;
+        }
+        auto back = adjacent(u);
+        if (!std::binary_search(back.begin(), back.end(), v)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+};
+
+// Owning CSR graph with sorted, deduplicated neighbour lists.
+struct Graph {
+  size_t n = 0;
+  std::vector<size_t> offsets;
+  std::vector<Vertex> neighbours;
+
+  GraphView view() const {
+    return {n, offsets, neighbours};
+  }
+
+  // edges must be sorted, deduplicated and normalized to first <= second
+  static Graph from_sorted_edges(size_t n, std::span<const std::pair<Vertex, Vertex>> edges) {
+    Graph graph;
+    graph.n = n;
+    graph.offsets.assign(n + 1, 0);
+
+    for (auto [v, u]: edges) {
+      ++graph.offsets[v + 1];
+      if (v != u) {
+        ++graph.offsets[u + 1];
+      }
+    }
+    for (Vertex v = 0; v < n; ++v) {
+      graph.offsets[v + 1] += graph.offsets[v];
+    }
+
+    graph.neighbours.resize(graph.offsets[n]);
+    std::vector<size_t> fill(graph.offsets.begin(), graph.offsets.end() - 1);
+    for (auto [v, u]: edges) {
+      graph.neighbours[fill[v]++] = u;
+      if (v != u) {
+        graph.neighbours[fill[u]++] = v;
+      }
+    }
+
+    return graph;
+  }
+};
+
+#endif //INC_3COLORING__GRAPH_HPP_
@@ -0,0 +1,323 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__GRAPHIO_HPP_
+#define INC_3COLORING__GRAPHIO_HPP_
+
+#include "Graph.hpp"
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Read-only memory mapping of a whole file.
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("Can't open file " + path);
+    }
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      throw std::runtime_error("Can't stat file " + path);
+    }
+
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ != 0) {
+      void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("Can't map file " + path);
+      }
+      data_ = static_cast<const char*>(data);
+      ::madvise(data, size_, MADV_SEQUENTIAL);
+    }
+    ::close(fd);
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&& other) noexcept: data_(other.data_), size_(other.size_) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+  }
+  MappedFile& operator=(MappedFile&& other) noexcept {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    return *this;
+  }
+
+  ~MappedFile() {
+    if (data_ != nullptr) {
+      ::munmap(const_cast<char*>(data_), size_);
+    }
+  }
+
+  const char* data() const {
+    return data_;
+  }
+  size_t size() const {
+    return size_;
+  }
+  std::string_view text() const {
+    return {data_, size_};
+  }
+
+ private:
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+struct EdgeList {
+  Graph graph;
+  std::string mode;  // trailing token after the edges ("fast" etc.), empty if absent
+};
+
+class EdgeListParser {
+ public:
+  explicit EdgeListParser(size_t threads = std::thread::hardware_concurrency()):
+      threads_(std::max<size_t>(threads, 1)) {}
+
+  EdgeList parse_file(const std::string& path) {
+    MappedFile file(path);
+    return parse(file.text());
+  }
+
+  // Format: "n m" followed by m pairs "v u" and an optional mode token.
+  EdgeList parse(std::string_view text) {
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+
+    size_t n = 0, m = 0;
+    const char* pos = begin;
+    if (!next_number_(pos, end, n) || !next_number_(pos, end, m)) {
+      if (pos != end) {
+        throw std::runtime_error("Malformed number '" + trailing_token_(pos, end) + "' in the edge list header");
+      }
+      throw std::runtime_error("Edge list header must contain n and m");
+    }
+
+    std::vector<std::pair<Vertex, Vertex>> edges(m);
+    parse_edges_(pos, end, edges);
+
+    for (auto& [v, u]: edges) {
+      if (v >= n || u >= n) {
+        throw std::range_error("Vertex " + std::to_string(std::max(v, u)) + " >= n = " + std::to_string(n));
+      }
+      if (v == u) {
+        throw std::runtime_error("Self-loop at vertex " + std::to_string(v));
+      }
+      if (u < v) {
+        std::swap(v, u);
+      }
+    }
+
+    sort_unique_(edges);
+
+    return {Graph::from_sorted_edges(n, edges), trailing_token_(pos, end)};
+  }
+
+ private:
+  static constexpr uint64_t kOnes = 0x0101010101010101;
+  static constexpr size_t kMaxDigits = 19;  // every number of 19 digits fits in 64 bits
+
+  static bool is_digit_(char c) {
+    return static_cast<unsigned char>(c - '0') < 10;
+  }
+  static bool is_space_(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+  }
+
+  // Number of leading digit bytes of 8 bytes loaded little-endian, all at once (SWAR): a byte is a
+  // digit iff its high nibble is 3 and its low nibble + 6 stays below 16; no sum carries out of a byte.
+  static size_t leading_digits_(uint64_t word) {
+    uint64_t bad = ((word & 0xF0 * kOnes) ^ 0x30 * kOnes) | (((word & 0x0F * kOnes) + 0x06 * kOnes) & 0x10 * kOnes);
+    uint64_t nonzero = (((bad & 0x7F * kOnes) + 0x7F * kOnes) | bad) & 0x80 * kOnes;
+    return static_cast<size_t>(std::countr_zero(nonzero)) / 8;
+  }
+
+  // Value of the first count (1 to 8) digits of the word: they are shifted to the top, so the bytes
+  // below become leading zeros, and adjacent digits, pairs and quads are combined by multiplication.
+  static uint64_t digits_value_(uint64_t word, size_t count) {
+    word = (word << (8 * (8 - count))) & 0x0F * kOnes;
+    word = ((word * (1 + (10 << 8))) >> 8) & 0x00FF00FF00FF00FF;
+    word = ((word * (1 + (100 << 16))) >> 16) & 0x0000FFFF0000FFFF;
+    return (word * (1 + (10000ULL << 32))) >> 32;
+  }
+
+  // The next whitespace-separated token as a number. False at the end of the text and at a token
+  // that is not a number of at most kMaxDigits digits; pos is at the start of that token then.
+  // Digits are scanned 8 at a time while the text has 8 more bytes.
+  static bool next_number_(const char*& pos, const char* end, size_t& value) {
+    while (pos != end && is_space_(*pos)) {
+      ++pos;
+    }
+
+    const char* p = pos;
+    uint64_t number = 0;
+    if constexpr (std::endian::native == std::endian::little) {
+      constexpr uint64_t kPowers[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+      while (end - p >= 8 && static_cast<size_t>(p - pos) <= kMaxDigits) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        size_t count = leading_digits_(word);
+        if (count != 0) {
+          number = number * kPowers[count] + digits_value_(word, count);
+          p += count;
+        }
+        if (count != 8) {
+          break;
+        }
+      }
+    }
+    while (p != end && is_digit_(*p) && static_cast<size_t>(p - pos) <= kMaxDigits) {
+      number = number * 10 + static_cast<uint64_t>(*p - '0');
+      ++p;
+    }
+
+    size_t digits = static_cast<size_t>(p - pos);
+    if (digits == 0 || digits > kMaxDigits || (p != end && !is_space_(*p))) {
+      return false;
+    }
+    value = number;
+    pos = p;
+    return true;
+  }
+
+  // Splits [begin, end) into chunks on whitespace boundaries, so no token is cut in two.
+  std::vector<const char*> split_(const char* begin, const char* end) const {
+    size_t chunks = std::min(threads_, static_cast<size_t>(end - begin) / kMinChunk + 1);
+    std::vector<const char*> bounds = {begin};
+
+    for (size_t i = 1; i < chunks; ++i) {
+      const char* bound = begin + (end - begin) * i / chunks;
+      bound = std::max(bound, bounds.back());
+      while (bound != end && !is_space_(*bound)) {
+        ++bound;
+      }
+      bounds.push_back(bound);
+    }
+    bounds.push_back(end);
+
+    return bounds;
+  }
+
+  template<class Function>
+  void run_parallel_(size_t tasks, Function function) const {
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < tasks; ++i) {
+      workers.emplace_back(function, i);
+    }
+    function(0);
+    for (auto& worker: workers) {
+      worker.join();
+    }
+  }
+
+  // Two passes over the mapped text: count numbers per chunk, then write each chunk
+  // at its prefix-sum offset. Only the first 2m numbers are edge endpoints; a chunk stops
+  // at its first token that is not a number, which is an error before the last endpoint.
+  void parse_edges_(const char*& pos, const char* end, std::vector<std::pair<Vertex, Vertex>>& edges) const {
+    auto bounds = split_(pos, end);
+    size_t chunks = bounds.size() - 1;
+    size_t needed = 2 * edges.size();
+
+    std::vector<size_t> counts(chunks + 1, 0);
+    std::vector<const char*> words(chunks, nullptr);
+    run_parallel_(chunks, [&](size_t i) {
+      const char* p = bounds[i];
+      size_t value;
+      while (next_number_(p, bounds[i + 1], value)) {
+        ++counts[i + 1];
+      }
+      if (p != bounds[i + 1]) {
+        words[i] = p;
+      }
+    });
+    const char* word = nullptr;
+    for (size_t i = 0; i < chunks; ++i) {
+      counts[i + 1] += counts[i];
+      if (word == nullptr && words[i] != nullptr) {
+        word = words[i];
+        if (counts[i + 1] < needed) {
+          throw std::runtime_error("Malformed number '" + trailing_token_(word, end) + "' in the edge list");
+        }
+      }
+    }
+    if (counts[chunks] < needed) {
+      throw std::runtime_error("Edge list is truncated: expected " + std::to_string(edges.size()) + " edges");
+    }
+
+    std::vector<const char*> stops(chunks, nullptr);
+    run_parallel_(chunks, [&](size_t i) {
+      const char* p = bounds[i];
+      size_t value;
+      for (size_t index = counts[i]; index < needed && next_number_(p, bounds[i + 1], value); ++index) {
+        auto& edge = edges[index / 2];
+        (index % 2 == 0 ? edge.first : edge.second) = value;
+      }
+      stops[i] = p;
+    });
+
+    for (size_t i = 0; i < chunks; ++i) {
+      if (counts[i] < needed && counts[i + 1] >= needed) {
+        pos = stops[i];
+      }
+    }
+  }
+
+  // Chunks are sorted independently and then merged pairwise, doubling the run length each round.
+  void sort_unique_(std::vector<std::pair<Vertex, Vertex>>& edges) const {
+    size_t chunks = std::min(threads_, edges.size() / kMinChunk + 1);
+    std::vector<size_t> bounds;
+    for (size_t i = 0; i <= chunks; ++i) {
+      bounds.push_back(edges.size() * i / chunks);
+    }
+
+    run_parallel_(chunks, [&](size_t i) {
+      std::sort(edges.begin() + bounds[i], edges.begin() + bounds[i + 1]);
+    });
+
+    for (size_t width = 1; width < chunks; width *= 2) {
+      size_t merges = (chunks + 2 * width - 1) / (2 * width);
+      run_parallel_(merges, [&](size_t i) {
+        size_t first = 2 * width * i;
+        size_t middle = std::min(first + width, chunks);
+        size_t last = std::min(first + 2 * width, chunks);
+        std::inplace_merge(edges.begin() + bounds[first], edges.begin() + bounds[middle],
+                           edges.begin() + bounds[last]);
+      });
+    }
+
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+  }
+
+  static std::string trailing_token_(const char* pos, const char* end) {
+    while (pos != end && std::isspace(static_cast<unsigned char>(*pos))) {
+      ++pos;
+    }
+    const char* token_end = pos;
+    while (token_end != end && !std::isspace(static_cast<unsigned char>(*token_end))) {
+      ++token_end;
+    }
+    return {pos, token_end};
+  }
+
+  static constexpr size_t kMinChunk = 1 << 16;
+  size_t threads_;
+};
+
+#endif //INC_3COLORING__GRAPHIO_HPP_
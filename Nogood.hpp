@@ -0,0 +1,207 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__NOGOOD_HPP_
+#define INC_3COLORING__NOGOOD_HPP_
+
+#include "SSS.hpp"
+#include "Graph.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <map>
+#include <optional>
+#include <vector>
+
+struct NogoodOptions {
+  size_t capacity = 4096;     // nogoods kept per component, the least active half goes when it's full
+  size_t max_size = 6;        // longer explanations aren't kept
+  size_t max_checks = 8;      // SSS re-solves spent on the explanation of one failed leaf
+  uint64_t check_nodes = 16;  // SSS nodes a re-solve may spend beyond those of the leaf it generalizes
+  double decay = 0.95;
+
+  // $COLORING_NOGOODS (capacity, no learning without it), $COLORING_NOGOOD_SIZE, $COLORING_NOGOOD_CHECKS
+  static std::optional<NogoodOptions> from_env() {
+    const char* capacity = std::getenv("COLORING_NOGOODS");
+    if (capacity == nullptr) {
+      return std::nullopt;
+    }
+
+    NogoodOptions options;
+    options.capacity = std::stoull(capacity);
+    if (const char* size = std::getenv("COLORING_NOGOOD_SIZE")) {
+      options.max_size = std::stoull(size);
+    }
+    if (const char* checks = std::getenv("COLORING_NOGOOD_CHECKS")) {
+      options.max_checks = std::stoull(checks);
+    }
+    return options;
+  }
+};
+
+struct NogoodStats {
+  size_t learned = 0;   // nogoods stored, color renamings included
+  size_t pruned = 0;    // seed tree nodes cut by a learned nogood
+  size_t deleted = 0;   // dropped for low activity
+  size_t checks = 0;    // SSS re-solves spent on explanations
+  size_t entries = 0;
+
+  NogoodStats& operator+=(const NogoodStats& other) {
+    learned += other.learned;
+    pruned += other.pruned;
+    deleted += other.deleted;
+    checks += other.checks;
+    entries += other.entries;
+    return *this;
+  }
+};
+
+// Learned nogoods of the seed tree of one component: sets of (seed, color) pairs that no coloring
+// of the core satisfies together. Seeds are colored in a fixed order, so a nogood can only become
+// violated when its deepest seed is colored and it is watched by that single pair. All colors are
+// interchangeable at the seeds, so a nogood is stored with every renaming of its colors.
+class NogoodStore {
+ public:
+  explicit NogoodStore(NogoodOptions options): options_(options) {}
+
+  const NogoodOptions& options() const {
+    return options_;
+  }
+
+  NogoodStats stats() const {
+    auto stats = stats_;
+    stats.entries = nogoods_.size();
+    return stats;
+  }
+
+  // One SSS re-solve spent on an explanation.
+  void count_check() {
+    ++stats_.checks;
+  }
+
+  // Whether coloring the pair, with assignment already holding, violates a nogood.
+  bool violated(const Pair& pair, const Coloring& assignment) {
+    auto nogood = find_(pair, assignment);
+    if (nogood == nullptr) {
+      return false;
+    }
+    nogood->activity += increment_;
+    ++stats_.pruned;
+    return true;
+  }
+
+  // Whether pairs, in seed order, contain a stored nogood.
+  bool contains_nogood(const std::vector<Pair>& pairs) {
+    Coloring assignment;
+    for (auto& pair: pairs) {
+      if (find_(pair, assignment) != nullptr) {
+        return true;
+      }
+      assignment[pair.vertex] = pair.color;
+    }
+    return false;
+  }
+
+  // Stores a nogood given in seed order, the deepest seed last.
+  void learn(const std::vector<Pair>& pairs) {
+    if (pairs.empty() || pairs.size() > options_.max_size || options_.capacity == 0) {
+      return;
+    }
+
+    std::array<Color, 3> rename = {0, 1, 2};
+    do {
+      std::vector<Pair> renamed;
+      renamed.reserve(pairs.size());
+      for (auto& pair: pairs) {
+        renamed.push_back({pair.vertex, rename[pair.color]});
+      }
+      if (!known_(renamed)) {
+        watches_[renamed.back()].push_back(nogoods_.size());
+        nogoods_.push_back({std::move(renamed), increment_});
+        ++stats_.learned;
+      }
+    } while (std::next_permutation(rename.begin(), rename.end()));
+
+    increment_ /= options_.decay;
+    if (increment_ > 1e100) {
+      for (auto& nogood: nogoods_) {
+        nogood.activity *= 1e-100;
+      }
+      increment_ *= 1e-100;
+    }
+    if (nogoods_.size() > options_.capacity) {
+      reduce_();
+    }
+  }
+
+ private:
+  struct Nogood {
+    std::vector<Pair> pairs;
+    double activity = 0;
+  };
+
+  // A nogood watched by pair whose other pairs all hold in assignment.
+  Nogood* find_(const Pair& pair, const Coloring& assignment) {
+    auto it = watches_.find(pair);
+    if (it == watches_.end()) {
+      return nullptr;
+    }
+    for (auto index: it->second) {
+      auto& nogood = nogoods_[index];
+      bool holds = std::all_of(nogood.pairs.begin(), nogood.pairs.end() - 1, [&](const Pair& other) {
+        auto found = assignment.find(other.vertex);
+        return found != assignment.end() && found->second == other.color;
+      });
+      if (holds) {
+        return &nogood;
+      }
+    }
+    return nullptr;
+  }
+
+  bool known_(const std::vector<Pair>& pairs) const {
+    auto it = watches_.find(pairs.back());
+    if (it == watches_.end()) {
+      return false;
+    }
+    return std::any_of(it->second.begin(), it->second.end(), [&](size_t index) {
+      return nogoods_[index].pairs == pairs;
+    });
+  }
+
+  // Keeps the more active half.
+  void reduce_() {
+    std::vector<size_t> order(nogoods_.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+      order[i] = i;
+    }
+    size_t keep = options_.capacity / 2;
+    std::nth_element(order.begin(), order.begin() + keep, order.end(), [&](size_t left, size_t right) {
+      return nogoods_[left].activity > nogoods_[right].activity;
+    });
+    order.resize(keep);
+    std::sort(order.begin(), order.end());
+
+    std::vector<Nogood> kept;
+    kept.reserve(keep);
+    for (auto index: order) {
+      kept.push_back(std::move(nogoods_[index]));
+    }
+    stats_.deleted += nogoods_.size() - kept.size();
+    nogoods_ = std::move(kept);
+
+    watches_.clear();
+    for (size_t i = 0; i < nogoods_.size(); ++i) {
+      watches_[nogoods_[i].pairs.back()].push_back(i);
+    }
+  }
+
+  NogoodOptions options_;
+  std::vector<Nogood> nogoods_;
+  std::map<Pair, std::vector<size_t>> watches_;  // deepest pair -> nogoods
+  double increment_ = 1;
+  NogoodStats stats_;
+};
+
+#endif //INC_3COLORING__NOGOOD_HPP_
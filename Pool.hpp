@@ -0,0 +1,223 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__POOL_HPP_
+#define INC_3COLORING__POOL_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <set>
+#include <utility>
+#include <vector>
+
+// Size-class pool for the tree nodes of the SSS containers. Blocks are carved from 64 KiB chunks
+// and recycled through per-thread free lists, so copying or dropping a branch state never reaches
+// malloc once the pool is warm. Chunks live until the process ends; a block freed by another
+// thread than the one that allocated it simply joins the free list of the freeing thread.
+class NodePool {
+ public:
+  static constexpr size_t kGranularity = 16;
+  static constexpr size_t kMaxBlock = 256;  // larger requests go to operator new
+  static constexpr size_t kChunkBytes = size_t(1) << 16;
+
+  struct Stats {
+    size_t allocations = 0;    // blocks handed out by this thread
+    size_t deallocations = 0;  // blocks returned by this thread
+    size_t live_bytes = 0;     // allocated - deallocated by this thread, may underflow across threads
+    size_t peak_bytes = 0;     // max of live_bytes since the last reset_stats()
+    size_t chunk_bytes = 0;    // bytes taken from the system by all threads, never shrinks
+  };
+
+  static void* allocate(size_t bytes) {
+    if (bytes > kMaxBlock) {
+      return ::operator new(bytes);
+    }
+
+    auto& cache = cache_();
+    size_t index = class_(bytes);
+    ++cache.stats.allocations;
+    cache.stats.live_bytes += size_of_(index);
+    cache.stats.peak_bytes = std::max(cache.stats.peak_bytes, cache.stats.live_bytes);
+
+    if (cache.free[index] == nullptr) {
+      cache.free[index] = depot_().take(index);
+    }
+    if (Block* block = cache.free[index]) {
+      cache.free[index] = block->next;
+      return block;
+    }
+
+    if (cache.end - cache.top < static_cast<std::ptrdiff_t>(size_of_(index))) {
+      cache.top = depot_().new_chunk();
+      cache.end = cache.top + kChunkBytes;
+    }
+    void* result = cache.top;
+    cache.top += size_of_(index);
+    return result;
+  }
+
+  static void deallocate(void* pointer, size_t bytes) {
+    if (bytes > kMaxBlock) {
+      ::operator delete(pointer);
+      return;
+    }
+
+    auto& cache = cache_();
+    size_t index = class_(bytes);
+    ++cache.stats.deallocations;
+    cache.stats.live_bytes -= size_of_(index);
+
+    auto block = static_cast<Block*>(pointer);
+    block->next = cache.free[index];
+    cache.free[index] = block;
+  }
+
+  // Counters of the calling thread, plus the chunk bytes of the whole process.
+  static Stats stats() {
+    Stats stats = cache_().stats;
+    stats.chunk_bytes = depot_().chunk_bytes.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+  // Takes chunks for at least this many bytes from the system now, so that the next allocations of
+  // any thread are served without it.
+  static void reserve(size_t bytes) {
+    auto& depot = depot_();
+    std::lock_guard lock(depot.mutex);
+    size_t spare = depot.spare.size() * kChunkBytes;
+    for (; spare < bytes; spare += kChunkBytes) {
+      depot.chunks.push_back(std::make_unique<std::byte[]>(kChunkBytes));
+      depot.spare.push_back(depot.chunks.back().get());
+      depot.chunk_bytes.fetch_add(kChunkBytes, std::memory_order_relaxed);
+    }
+  }
+
+  static void reset_stats() {
+    auto& stats = cache_().stats;
+    stats.allocations = 0;
+    stats.deallocations = 0;
+    stats.peak_bytes = stats.live_bytes;
+  }
+
+ private:
+  static constexpr size_t kClasses = kMaxBlock / kGranularity;
+
+  struct Block {
+    Block* next;
+  };
+
+  static size_t class_(size_t bytes) {
+    return bytes == 0 ? 0 : (bytes - 1) / kGranularity;
+  }
+  static size_t size_of_(size_t index) {
+    return (index + 1) * kGranularity;
+  }
+
+  // Owns the chunks and keeps the free lists of finished threads.
+  struct Depot {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<std::byte[]>> chunks;
+    std::vector<std::byte*> spare;  // reserved chunks not handed to a thread yet
+    std::array<Block*, kClasses> free{};
+    std::atomic<size_t> parked = 0;  // non-empty lists in free, checked without the lock
+    std::atomic<size_t> chunk_bytes = 0;
+
+    std::byte* new_chunk() {
+      std::lock_guard lock(mutex);
+      if (!spare.empty()) {
+        std::byte* chunk = spare.back();
+        spare.pop_back();
+        return chunk;
+      }
+      chunks.push_back(std::make_unique<std::byte[]>(kChunkBytes));
+      chunk_bytes.fetch_add(kChunkBytes, std::memory_order_relaxed);
+      return chunks.back().get();
+    }
+
+    Block* take(size_t index) {
+      if (parked.load(std::memory_order_relaxed) == 0) {
+        return nullptr;
+      }
+      std::lock_guard lock(mutex);
+      if (free[index] != nullptr) {
+        parked.fetch_sub(1, std::memory_order_relaxed);
+      }
+      return std::exchange(free[index], nullptr);
+    }
+
+    void give(size_t index, Block* list) {
+      if (list == nullptr) {
+        return;
+      }
+      std::lock_guard lock(mutex);
+      Block* last = list;
+      while (last->next != nullptr) {
+        last = last->next;
+      }
+      if (free[index] == nullptr) {
+        parked.fetch_add(1, std::memory_order_relaxed);
+      }
+      last->next = free[index];
+      free[index] = list;
+    }
+  };
+
+  struct Cache {
+    std::array<Block*, kClasses> free{};
+    std::byte* top = nullptr;
+    std::byte* end = nullptr;
+    Stats stats;
+
+    ~Cache() {
+      for (size_t index = 0; index < kClasses; ++index) {
+        depot_().give(index, free[index]);
+      }
+    }
+  };
+
+  // never destroyed, so blocks stay valid in the thread_local destructors of any thread
+  static Depot& depot_() {
+    static Depot* depot = new Depot();
+    return *depot;
+  }
+
+  static Cache& cache_() {
+    thread_local Cache cache;
+    return cache;
+  }
+};
+
+template<class T>
+struct PoolAllocator {
+  using value_type = T;
+
+  PoolAllocator() = default;
+  template<class U>
+  PoolAllocator(const PoolAllocator<U>&) {}
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(NodePool::allocate(n * sizeof(T)));
+  }
+  void deallocate(T* pointer, size_t n) {
+    NodePool::deallocate(pointer, n * sizeof(T));
+  }
+
+  template<class U>
+  bool operator==(const PoolAllocator<U>&) const {
+    return true;
+  }
+};
+
+template<class T, class Compare = std::less<T>>
+using PoolSet = std::set<T, Compare, PoolAllocator<T>>;
+template<class Key, class Value>
+using PoolMap = std::map<Key, Value, std::less<Key>, PoolAllocator<std::pair<const Key, Value>>>;
+
+#endif //INC_3COLORING__POOL_HPP_
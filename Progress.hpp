@@ -0,0 +1,194 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__PROGRESS_HPP_
+#define INC_3COLORING__PROGRESS_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <thread>
+
+struct ProgressOptions {
+  std::chrono::milliseconds interval{1000};
+
+  // $COLORING_PROGRESS (seconds between reports, no reports without it)
+  static std::optional<ProgressOptions> from_env() {
+    const char* interval = std::getenv("COLORING_PROGRESS");
+    if (interval == nullptr) {
+      return std::nullopt;
+    }
+
+    ProgressOptions options;
+    options.interval = std::max(std::chrono::milliseconds(static_cast<int64_t>(std::stod(interval) * 1000)),
+                                std::chrono::milliseconds(1));
+    return options;
+  }
+};
+
+struct ProgressSnapshot {
+  double elapsed_seconds = 0;
+  uint64_t nodes = 0;             // SSS<3, 2>::solve() calls
+  double nodes_per_second = 0;
+  size_t components_done = 0;
+  double fraction = 0;            // of the seed space of the component in progress, refuted
+  std::optional<double> remaining_nodes;
+  std::optional<double> eta_seconds;
+
+  void write_json(std::ostream& out) const {
+    out << "{\"elapsed_seconds\":" << elapsed_seconds << ",\"nodes\":" << nodes
+        << ",\"nodes_per_second\":" << nodes_per_second << ",\"components_done\":" << components_done
+        << ",\"fraction\":" << fraction;
+    if (remaining_nodes) {
+      out << ",\"remaining_nodes\":" << *remaining_nodes << ",\"eta_seconds\":" << *eta_seconds;
+    }
+    out << "}";
+  }
+};
+
+// Progress of the exact search on the thread that runs it, read from any thread.
+//
+// Every branch of the seed tree of solve_connected() weighs 1/k of its parent, k being the
+// colors the parent tries, so the refuted fraction of the seed space is the sum of the weights of
+// the refuted leaves and of the branches cut by propagation. Its size is estimated Knuth-style:
+// random dives through the seed tree with propagation average the product of the branching
+// factors met, which estimates the number of seed leaves, and the SSS<3, 2> nodes per leaf are
+// the mean of the leaves already searched. Remaining nodes are that total times the unrefuted
+// fraction.
+class SearchProgress {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  SearchProgress(): begin_(Clock::now()) {}
+
+  // The tracker of the calling thread, nullptr when nobody watches.
+  static SearchProgress* current() {
+    return current_();
+  }
+
+  // One SSS node; costs a thread_local load when progress is off.
+  static void node() {
+    if (auto progress = current_()) {
+      progress->nodes_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  void begin_component(double estimated_leaves) {
+    fraction_.store(0, std::memory_order_relaxed);
+    estimated_leaves_.store(estimated_leaves, std::memory_order_relaxed);
+    leaves_.store(0, std::memory_order_relaxed);
+    leaf_nodes_.store(0, std::memory_order_relaxed);
+  }
+
+  void finish_component() {
+    components_done_.fetch_add(1, std::memory_order_relaxed);
+    fraction_.store(0, std::memory_order_relaxed);
+    estimated_leaves_.store(0, std::memory_order_relaxed);
+  }
+
+  // A seed tree branch of this weight holds no coloring.
+  void refuted(double weight) {
+    fraction_.fetch_add(weight, std::memory_order_relaxed);
+  }
+
+  // A seed tree leaf whose SSS took this many nodes.
+  void leaf(uint64_t nodes) {
+    leaves_.fetch_add(1, std::memory_order_relaxed);
+    leaf_nodes_.fetch_add(nodes, std::memory_order_relaxed);
+  }
+
+  uint64_t nodes() const {
+    return nodes_.load(std::memory_order_relaxed);
+  }
+
+  ProgressSnapshot snapshot() const {
+    ProgressSnapshot snapshot;
+    snapshot.elapsed_seconds = std::chrono::duration<double>(Clock::now() - begin_).count();
+    snapshot.nodes = nodes();
+    snapshot.nodes_per_second = snapshot.elapsed_seconds > 0 ? static_cast<double>(snapshot.nodes) / snapshot.elapsed_seconds : 0;
+    snapshot.components_done = components_done_.load(std::memory_order_relaxed);
+    snapshot.fraction = std::min(fraction_.load(std::memory_order_relaxed), 1.0);
+
+    auto leaves = leaves_.load(std::memory_order_relaxed);
+    auto estimated_leaves = estimated_leaves_.load(std::memory_order_relaxed);
+    if (leaves != 0 && estimated_leaves > 0) {
+      double per_leaf = static_cast<double>(leaf_nodes_.load(std::memory_order_relaxed)) / static_cast<double>(leaves);
+      snapshot.remaining_nodes = estimated_leaves * per_leaf * (1 - snapshot.fraction);
+      snapshot.eta_seconds = snapshot.nodes_per_second > 0 ? *snapshot.remaining_nodes / snapshot.nodes_per_second : 0;
+    }
+    return snapshot;
+  }
+
+ private:
+  friend class ProgressScope;
+
+  static SearchProgress*& current_() {
+    thread_local SearchProgress* progress = nullptr;
+    return progress;
+  }
+
+  Clock::time_point begin_;
+  std::atomic<uint64_t> nodes_ = 0;
+  std::atomic<size_t> components_done_ = 0;
+  std::atomic<double> fraction_ = 0;
+  std::atomic<double> estimated_leaves_ = 0;
+  std::atomic<uint64_t> leaves_ = 0;
+  std::atomic<uint64_t> leaf_nodes_ = 0;
+};
+
+// Makes progress the tracker of the calling thread for its lifetime.
+class ProgressScope {
+ public:
+  explicit ProgressScope(SearchProgress& progress): previous_(SearchProgress::current_()) {
+    SearchProgress::current_() = &progress;
+  }
+  ProgressScope(const ProgressScope&) = delete;
+  ProgressScope& operator=(const ProgressScope&) = delete;
+  ~ProgressScope() {
+    SearchProgress::current_() = previous_;
+  }
+
+ private:
+  SearchProgress* previous_;
+};
+
+// Side thread that hands a snapshot to publish every interval until it is destroyed.
+class ProgressReporter {
+ public:
+  ProgressReporter(const SearchProgress& progress, std::chrono::milliseconds interval,
+                   std::function<void(const ProgressSnapshot&)> publish):
+      thread_([this, &progress, interval, publish = std::move(publish)] {
+        std::unique_lock lock(mutex_);
+        while (!stop_cv_.wait_for(lock, interval, [this] { return stopped_; })) {
+          publish(progress.snapshot());
+        }
+      }) {}
+
+  ProgressReporter(const ProgressReporter&) = delete;
+  ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+  ~ProgressReporter() {
+    {
+      std::lock_guard lock(mutex_);
+      stopped_ = true;
+    }
+    stop_cv_.notify_all();
+    thread_.join();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable stop_cv_;
+  bool stopped_ = false;
+  std::thread thread_;  // last: starts once the members above exist
+};
+
+#endif //INC_3COLORING__PROGRESS_HPP_
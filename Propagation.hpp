@@ -0,0 +1,195 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__PROPAGATION_HPP_
+#define INC_3COLORING__PROPAGATION_HPP_
+
+#include "SSS.hpp"
+#include <bit>
+#include <cstdint>
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+// Color domains of n vertexes as three n-bit planes plus a plane of already propagated vertexes.
+class BitDomains {
+ public:
+  bool has(size_t index, Color color) const {
+    return (plane_(color)[index / 64] >> (index % 64)) & 1;
+  }
+
+ private:
+  friend class BitPropagator;
+
+  uint64_t* plane_(size_t plane) {
+    return words_.data() + plane * words_per_plane_;
+  }
+  const uint64_t* plane_(size_t plane) const {
+    return words_.data() + plane * words_per_plane_;
+  }
+
+  size_t words_per_plane_ = 0;
+  std::vector<uint64_t> words_;
+};
+
+// Arc consistency for 3-coloring over bit rows: every fixed vertex removes its color from the
+// adjacency row of each plane, until no new vertex gets fixed or some domain becomes empty.
+class BitPropagator {
+ public:
+  static constexpr size_t kColors = 3;
+  static constexpr size_t kDone = kColors;
+  // adjacency takes n^2 / 8 bytes
+  static constexpr size_t kMaxVertexes = 1 << 14;
+
+  template<class EdgesMap>
+  explicit BitPropagator(const EdgesMap& edges) {
+    for (auto& item: edges) {
+      index_[item.first] = vertexes_.size();
+      vertexes_.push_back(item.first);
+    }
+
+    words_ = (vertexes_.size() + 63) / 64;
+    adjacency_.assign(vertexes_.size() * words_, 0);
+    for (auto& item: edges) {
+      uint64_t* row = row_(index_.at(item.first));
+      for (auto v: item.second) {
+        size_t i = index_.at(v);
+        row[i / 64] |= uint64_t(1) << (i % 64);
+      }
+    }
+  }
+
+  size_t size() const {
+    return vertexes_.size();
+  }
+  Vertex vertex(size_t index) const {
+    return vertexes_[index];
+  }
+  size_t index(Vertex vertex) const {
+    return index_.at(vertex);
+  }
+
+  BitDomains full_domains() const {
+    BitDomains domains;
+    domains.words_per_plane_ = words_;
+    domains.words_.assign((kColors + 1) * words_, 0);
+
+    for (size_t c = 0; c < kColors; ++c) {
+      uint64_t* plane = domains.plane_(c);
+      for (size_t w = 0; w < words_; ++w) {
+        plane[w] = valid_(w);
+      }
+    }
+
+    return domains;
+  }
+
+  // Restricts the vertex to one color, propagation is left to propagate().
+  void assign(BitDomains& domains, Vertex vertex, Color color) const {
+    size_t i = index_.at(vertex);
+    uint64_t bit = uint64_t(1) << (i % 64);
+
+    for (size_t c = 0; c < kColors; ++c) {
+      if (c != color) {
+        domains.plane_(c)[i / 64] &= ~bit;
+      }
+    }
+  }
+
+  // Calls function(vertex, color) for every color in `before` but not in `after`.
+  template<class Function>
+  void for_each_removed(const BitDomains& before, const BitDomains& after, Function function) const {
+    for (size_t c = 0; c < kColors; ++c) {
+      const uint64_t* was = before.plane_(c);
+      const uint64_t* now = after.plane_(c);
+      for (size_t w = 0; w < words_; ++w) {
+        for (uint64_t removed = was[w] & ~now[w]; removed != 0; removed &= removed - 1) {
+          function(vertexes_[w * 64 + std::countr_zero(removed)], static_cast<Color>(c));
+        }
+      }
+    }
+  }
+
+  // Returns false if some vertex has lost all its colors.
+  bool propagate(BitDomains& domains) const {
+    uint64_t* planes[kColors] = {domains.plane_(0), domains.plane_(1), domains.plane_(2)};
+    uint64_t* done = domains.plane_(kDone);
+
+    bool changed = true;
+    while (changed) {
+      changed = false;
+
+      for (size_t w = 0; w < words_; ++w) {
+        uint64_t p0 = planes[0][w], p1 = planes[1][w], p2 = planes[2][w];
+        if (~(p0 | p1 | p2) & valid_(w)) {
+          return false;
+        }
+
+        uint64_t single = (p0 ^ p1 ^ p2) & ~(p0 & p1 & p2);
+        uint64_t fresh = single & ~done[w];
+        done[w] |= fresh;
+
+        while (fresh != 0) {
+          size_t i = w * 64 + std::countr_zero(fresh);
+          fresh &= fresh - 1;
+
+          uint64_t bit = uint64_t(1) << (i % 64);
+          size_t color = (planes[0][w] & bit) ? 0 : ((planes[1][w] & bit) ? 1 : 2);
+          and_not_(planes[color], row_(i), words_);
+          changed = true;
+        }
+      }
+    }
+
+    for (size_t w = 0; w < words_; ++w) {
+      if (~(planes[0][w] | planes[1][w] | planes[2][w]) & valid_(w)) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+ private:
+  uint64_t valid_(size_t word) const {
+    size_t rest = vertexes_.size() - word * 64;
+    return rest >= 64 ? ~uint64_t(0) : (uint64_t(1) << rest) - 1;
+  }
+
+  uint64_t* row_(size_t index) {
+    return adjacency_.data() + index * words_;
+  }
+  const uint64_t* row_(size_t index) const {
+    return adjacency_.data() + index * words_;
+  }
+
+  // dst &= ~src
+  static void and_not_(uint64_t* dst, const uint64_t* src, size_t words) {
+    size_t w = 0;
+#if defined(__AVX512F__)
+    for (; w + 8 <= words; w += 8) {
+      __m512i d = _mm512_loadu_si512(dst + w);
+      __m512i s = _mm512_loadu_si512(src + w);
+      _mm512_storeu_si512(dst + w, _mm512_andnot_si512(s, d));
+    }
+#endif
+#if defined(__AVX2__)
+    for (; w + 4 <= words; w += 4) {
+      __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + w));
+      __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + w));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + w), _mm256_andnot_si256(s, d));
+    }
+#endif
+    for (; w < words; ++w) {
+      dst[w] &= ~src[w];
+    }
+  }
+
+  size_t words_ = 0;
+  std::vector<uint64_t> adjacency_;
+  std::vector<Vertex> vertexes_;
+  std::map<Vertex, size_t> index_;
+};
+
+#endif //INC_3COLORING__PROPAGATION_HPP_
@@ -2,12 +2,28 @@
 // Created by aleks311001 on 05.01.2022.
 //
 
+#include "Cow.hpp"
+#include "Pool.hpp"
+#include "Trace.hpp"
+#include "Deadline.hpp"
+#include "Progress.hpp"
 #include <iostream>
 #include <set>
 #include <unordered_set>
 #include <vector>
 #include <map>
 #include <exception>
+#include <stdexcept>
+#include <array>
+#include <cstdint>
+#include <algorithm>
+#include <optional>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <functional>
 
 #ifndef INC_3COLORING__SSS_H_
 #define INC_3COLORING__SSS_H_
@@ -21,11 +37,12 @@ struct Pair {
   auto operator<=>(const Pair& other) const = default;
 };
 
-class Constraint: public std::set<Pair> {
+class Constraint: public PoolSet<Pair> {
  public:
-  Constraint(std::initializer_list<Pair> list): std::set<Pair>(list) {}
-  Constraint(const std::set<Pair>& set): std::set<Pair>(set) {}
-  Constraint(std::set<Pair>&& set): std::set<Pair>(std::move(set)) {}
+  Constraint(std::initializer_list<Pair> list): PoolSet<Pair>(list) {}
+  Constraint(const std::set<Pair>& set): PoolSet<Pair>(set.begin(), set.end()) {}
+  Constraint(const PoolSet<Pair>& set): PoolSet<Pair>(set) {}
+  Constraint(PoolSet<Pair>&& set): PoolSet<Pair>(std::move(set)) {}
 
   bool operator<(const Constraint& other) const {
     if (this->size() != other.size()) {
@@ -43,26 +60,194 @@ class Constraint: public std::set<Pair> {
     return false;
   }
 };
-using Constraints = std::set<Constraint>;
 
-class Constraints_iterator : public Constraints::iterator {
+// Shards of kSize consecutive vertexes.
+struct VertexShard {
+  static constexpr size_t kSize = 16;
+
+  size_t operator()(Vertex vertex) const {
+    return vertex / kSize;
+  }
+  size_t operator()(const Pair& pair) const {
+    return pair.vertex / kSize;
+  }
+};
+
+// Constraints indexed by pair: each one is kept in the entry of every pair it has, so the
+// constraints of a pair are one lookup away, and the entries are copy-on-write by vertex shard.
+// Iteration visits each constraint once, from the entry of its smallest pair.
+class Constraints {
+  using Index = ShardedCow<PoolMap<Pair, PoolSet<Constraint>>, VertexShard>;
+
  public:
-  Constraints_iterator(const Constraints::iterator& iterator): Constraints::iterator(iterator) {}
-  Constraints_iterator(Constraints::iterator&& iterator): Constraints::iterator(std::move(iterator)) {}
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Constraint;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Constraint*;
+    using reference = const Constraint&;
+
+    reference operator*() const {
+      return *inner_;
+    }
+    pointer operator->() const {
+      return &*inner_;
+    }
+
+    const_iterator& operator++() {
+      ++inner_;
+      settle_();
+      return *this;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return outer_ == other.outer_ && (outer_ == outer_end_ || inner_ == other.inner_);
+    }
+
+   private:
+    friend class Constraints;
+
+    const_iterator(Index::const_iterator outer, Index::const_iterator outer_end):
+        outer_(outer), outer_end_(outer_end) {
+      if (outer_ != outer_end_) {
+        inner_ = outer_->second.begin();
+      }
+      settle_();
+    }
+
+    // to the next constraint whose smallest pair is the one of its entry
+    void settle_() {
+      while (outer_ != outer_end_) {
+        auto& [pair, constraints] = *outer_;
+        for (; inner_ != constraints.end(); ++inner_) {
+          if (*inner_->begin() == pair) {
+            return;
+          }
+        }
+        if (++outer_ != outer_end_) {
+          inner_ = outer_->second.begin();
+        }
+      }
+    }
+
+    Index::const_iterator outer_, outer_end_;
+    PoolSet<Constraint>::const_iterator inner_;
+  };
+
+  const_iterator begin() const {
+    return {index_.begin(), index_.end()};
+  }
+  const_iterator end() const {
+    return {index_.end(), index_.end()};
+  }
+
+  size_t size() const {
+    return size_;
+  }
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  bool contains(const Constraint& constraint) const {
+    return !constraint.empty() && of(*constraint.begin()).contains(constraint);
+  }
+
+  // Valid until the next change.
+  const PoolSet<Constraint>& of(const Pair& pair) const {
+    static const PoolSet<Constraint> kNone;
+    auto it = index_.find(pair);
+    return it != index_.end() ? it->second : kNone;
+  }
+
+  void insert(const Constraint& constraint) {
+    if (constraint.empty() || contains(constraint)) {
+      return;
+    }
+    for (auto& pair: constraint) {
+      index_.mutate(pair).insert(constraint);
+    }
+    ++size_;
+  }
+
+  // By value: constraint may live in the entries it is erased from.
+  void erase(Constraint constraint) {
+    if (!contains(constraint)) {
+      return;
+    }
+    for (auto& pair: constraint) {
+      auto& constraints = index_.mutate(pair);
+      constraints.erase(constraint);
+      if (constraints.empty()) {
+        index_.erase(pair);
+      }
+    }
+    --size_;
+  }
+
+ private:
+  Index index_;
+  size_t size_ = 0;
+};
+
+class Constraints_iterator : public Constraints::const_iterator {
+ public:
+  Constraints_iterator(const Constraints::const_iterator& iterator): Constraints::const_iterator(iterator) {}
+  Constraints_iterator(Constraints::const_iterator&& iterator): Constraints::const_iterator(std::move(iterator)) {}
 
   bool operator<(const Constraints_iterator& other) const {
     return **this < *other;
   }
 };
 
+// Color universe {0, ..., a - 1} and lookups by color mask, all computed at compile time.
+template<size_t a>
+struct ColorTable {
+  static_assert(a <= 8, "Color masks are tables of 2^a entries");
+
+  using Mask = uint32_t;
+  static constexpr Mask kAll = (Mask(1) << a) - 1;
+
+  static constexpr Mask mask(Color color) {
+    return Mask(1) << color;
+  }
+
+  static constexpr std::array<Color, a> colors = [] {
+    std::array<Color, a> result{};
+    for (Color c = 0; c < a; ++c) {
+      result[c] = c;
+    }
+    return result;
+  }();
+
+  // smallest color outside of the mask (a if there is none)
+  static constexpr std::array<Color, (size_t(1) << a)> first_missing = [] {
+    std::array<Color, (size_t(1) << a)> result{};
+    for (Mask m = 0; m <= kAll; ++m) {
+      Color c = 0;
+      while (c < a && (m & mask(c))) {
+        ++c;
+      }
+      result[m] = c;
+    }
+    return result;
+  }();
+
+  // two smallest colors different from the given one
+  static constexpr std::array<std::pair<Color, Color>, a> other_two = [] {
+    std::array<std::pair<Color, Color>, a> result{};
+    for (Color c = 0; c < a; ++c) {
+      Color first = first_missing[mask(c)];
+      result[c] = {first, first_missing[mask(c) | mask(first)]};
+    }
+    return result;
+  }();
+};
+
 template<size_t a, size_t b>
 class BaseSSS {
  public:
-  BaseSSS() {
-    for (Color c = 0; c < a; ++c) {
-      colors_.insert(c);
-    }
-  }
+  BaseSSS() = default;
 
   BaseSSS(const BaseSSS&) = default;
   BaseSSS& operator=(const BaseSSS&) = default;
@@ -75,7 +260,10 @@ class BaseSSS {
   size_t num_constraints();
 
   void add_constraint(const Constraint& constraint);
-  std::vector<Constraints::iterator> get_constraints(const Pair& pair);
+  // Valid until the next change of the constraints.
+  const PoolSet<Constraint>& get_constraints(const Pair& pair) const {
+    return constraints_.of(pair);
+  }
 
   void reset_vertexes();
   void set_vertexes(size_t num);
@@ -88,21 +276,42 @@ class BaseSSS {
   void add_all_colors(Vertex vertex);
   void add_all_colors();
   void set_allow_colors(const std::map<Vertex, std::set<Color>>& allowed_colors) {
-    allowed_colors_ = allowed_colors;
+    allowed_colors_.clear();
+    for (auto& [vertex, set]: allowed_colors) {
+      allowed_colors_.insert({vertex, PoolSet<Color>(set.begin(), set.end())});
+    }
   }
   void drop_allow_color(const Pair& pair, bool drop_constraints = true);
-  bool is_allow_color(const Pair& pair) {
-    return allowed_colors_[pair.vertex].contains(pair.color);
+  bool is_allow_color(const Pair& pair) const {
+    return allowed_colors_of_(pair.vertex).contains(pair.color);
   }
 
-  std::set<Color> get_allow_color(Vertex vertex) {
-    return allowed_colors_[vertex];
+  std::set<Color> get_allow_color(Vertex vertex) const {
+    auto& colors = allowed_colors_of_(vertex);
+    return {colors.begin(), colors.end()};
+  }
+  bool has_vertex(Vertex vertex) const {
+    return vertexes_.contains(vertex);
   }
 
  protected:
-  std::set<Color> colors_;
-  std::set<Vertex> vertexes_;
-  std::map<Vertex, std::set<Color>> allowed_colors_;
+  const PoolSet<Color>& allowed_colors_of_(Vertex vertex) const {
+    static const PoolSet<Color> kNone;
+    auto it = allowed_colors_.find(vertex);
+    return it != allowed_colors_.end() ? it->second : kNone;
+  }
+
+  void erase_constraints_(const Pair& pair) {
+    while (!get_constraints(pair).empty()) {
+      constraints_.erase(*get_constraints(pair).begin());
+    }
+  }
+
+  static constexpr auto colors_ = ColorTable<a>::colors;
+  // sharded copy-on-write: a copy of the state shares every shard and a branch clones only the
+  // shards of the vertexes it changes; tree nodes come from NodePool, so the clones don't reach malloc
+  ShardedCow<PoolSet<Vertex>, VertexShard> vertexes_;
+  ShardedCow<PoolMap<Vertex, PoolSet<Color>>, VertexShard> allowed_colors_;
   Constraints constraints_;
 };
 
@@ -128,7 +337,7 @@ void BaseSSS<a, b>::add_constraint(const Constraint &constraint) {
       std::string message = "Vertex from constraint don't allowed (" + std::to_string(pair.vertex) + ")";
       throw std::range_error(message);
     }
-    if (!allowed_colors_[pair.vertex].contains(pair.color)) {
+    if (!allowed_colors_of_(pair.vertex).contains(pair.color)) {
       std::string message = "Color " + std::to_string(pair.color) + " don't allowed for vertex " + std::to_string(pair.vertex);
       throw std::range_error(message);
     }
@@ -147,18 +356,6 @@ void BaseSSS<a, b>::add_constraint(const Constraint &constraint) {
 
   constraints_.insert(constraint);
 }
-template<size_t a, size_t b>
-std::vector<Constraints::iterator> BaseSSS<a, b>::get_constraints(const Pair &pair) {
-  std::vector<Constraints::iterator> result;
-
-  for (auto it = constraints_.begin(); it != constraints_.end(); ++it) {
-    if (it->contains(pair)) {
-      result.push_back(it);
-    }
-  }
-
-  return result;
-}
 
 template<size_t a, size_t b>
 void BaseSSS<a, b>::reset_vertexes() {
@@ -177,15 +374,14 @@ void BaseSSS<a, b>::set_vertexes(size_t num) {
 }
 template<size_t a, size_t b>
 void BaseSSS<a, b>::drop_vertex(Vertex vertex, bool drop_constraints) {
-  size_t n =vertexes_.erase(vertex);
+  if (!vertexes_.contains(vertex) && !allowed_colors_.contains(vertex)) {
+    return;
+  }
+  size_t n = vertexes_.erase(vertex);
 
   if (drop_constraints && n >= 1) {
-    for (auto color: allowed_colors_[vertex]){
-      auto iterators = get_constraints({vertex, color});
-
-      for (auto& iter: iterators) {
-        constraints_.erase(iter);
-      }
+    for (auto color: allowed_colors_of_(vertex)){
+      erase_constraints_({vertex, color});
     }
   }
 
@@ -198,7 +394,7 @@ void BaseSSS<a, b>::reset_colors() {
 }
 template<size_t a, size_t b>
 void BaseSSS<a, b>::reset_colors(Vertex vertex) {
-  allowed_colors_[vertex].clear();
+  allowed_colors_.mutate(vertex).clear();
 }
 template<size_t a, size_t b>
 void BaseSSS<a, b>::add_color(const Pair& pair) {
@@ -207,17 +403,19 @@ void BaseSSS<a, b>::add_color(const Pair& pair) {
     throw std::overflow_error(message);
   }
 
-  allowed_colors_[pair.vertex].insert(pair.color);
-  if (allowed_colors_[pair.vertex].size() > a) {
+  auto& colors = allowed_colors_.mutate(pair.vertex);
+  colors.insert(pair.color);
+  if (colors.size() > a) {
     std::string message = "Size of allowed colors set of vertex " + std::to_string(pair.vertex) + " = " +
-                          std::to_string(allowed_colors_[pair.vertex].size()) + " > " + std::to_string(a) + " = a";
+                          std::to_string(colors.size()) + " > " + std::to_string(a) + " = a";
     throw std::overflow_error(message);
   }
 }
 template<size_t a, size_t b>
 void BaseSSS<a, b>::add_all_colors(Vertex vertex) {
+  auto& colors = allowed_colors_.mutate(vertex);
   for (auto color: colors_) {
-    allowed_colors_[vertex].insert(color);
+    colors.insert(color);
   }
 }
 template<size_t a, size_t b>
@@ -228,14 +426,13 @@ void BaseSSS<a, b>::add_all_colors() {
 }
 template<size_t a, size_t b>
 void BaseSSS<a, b>::drop_allow_color(const Pair &pair, bool drop_constraints) {
-  size_t n = allowed_colors_[pair.vertex].erase(pair.color);
-
-  if (drop_constraints && n >= 1) {
-    auto iterators = get_constraints(pair);
+  if (!allowed_colors_of_(pair.vertex).contains(pair.color)) {
+    return;
+  }
+  allowed_colors_.mutate(pair.vertex).erase(pair.color);
 
-    for (auto& iter: iterators) {
-      constraints_.erase(iter);
-    }
+  if (drop_constraints) {
+    erase_constraints_(pair);
   }
 }
 
@@ -247,7 +444,7 @@ template<size_t a>
 class BaseColoringSSS: public BaseSSS<a, 2> {
  public:
   bool drop_2_colors_vertexes(Vertex vertex) {
-    auto set_colors = this->allowed_colors_[vertex];
+    auto set_colors = this->allowed_colors_of_(vertex);
     auto colors = std::vector(set_colors.begin(), set_colors.end());
 
     if (colors.size() != 2) {
@@ -257,15 +454,20 @@ class BaseColoringSSS: public BaseSSS<a, 2> {
     Pair pair_R = Pair{vertex, colors[0]};
     Pair pair_G = Pair{vertex, colors[1]};
 
-    auto constraints_R = this->get_constraints(pair_R);
-    auto constraints_G = this->get_constraints(pair_G);
+    // the other pairs are collected first, the loop below changes the constraints
+    std::vector<Pair> pairs_R2, pairs_G2;
+    for (auto& constraint: this->get_constraints(pair_R)) {
+      pairs_R2.push_back(get_other_pair(constraint, pair_R));
+    }
+    for (auto& constraint: this->get_constraints(pair_G)) {
+      pairs_G2.push_back(get_other_pair(constraint, pair_G));
+    }
 
-    std::set<Pair> disable_colors;
-    for (auto it_constraint_R: constraints_R) {
-      for (auto it_constraint_G: constraints_G) {
-        auto pair_R2 = get_other_pair(*it_constraint_R, pair_R);
-        auto pair_G2 = get_other_pair(*it_constraint_G, pair_G);
+    eliminated_.push_back({vertex, colors[0], colors[1], pairs_R2});
 
+    std::set<Pair> disable_colors;
+    for (auto& pair_R2: pairs_R2) {
+      for (auto& pair_G2: pairs_G2) {
         if (pair_R2 != pair_G2) {
           this->add_constraint({pair_R2, pair_G2});
         } else {
@@ -295,7 +497,7 @@ class BaseColoringSSS: public BaseSSS<a, 2> {
   }
 
   bool drop_1_colors_vertexes(Vertex vertex) {
-    auto set_colors = this->allowed_colors_[vertex];
+    auto set_colors = this->allowed_colors_of_(vertex);
 
     if (set_colors.size() != 1) {
       return false;
@@ -303,13 +505,15 @@ class BaseColoringSSS: public BaseSSS<a, 2> {
 
     Color color = *set_colors.begin();
     Pair pair = {vertex, color};
-    auto constraints = this->get_constraints(pair);
-
-    for (auto constraint: constraints) {
-      auto pair2 = get_other_pair(*constraint, pair);
+    std::vector<Pair> pairs2;
+    for (auto& constraint: this->get_constraints(pair)) {
+      pairs2.push_back(get_other_pair(constraint, pair));
+    }
+    for (auto& pair2: pairs2) {
       this->drop_allow_color(pair2);
     }
 
+    eliminated_.push_back({vertex, color, color, {}});
     this->drop_vertex(vertex);
 
     return true;
@@ -337,7 +541,7 @@ class BaseColoringSSS: public BaseSSS<a, 2> {
 
   bool has_uncolored_vertex() {
     for (auto vertex: this->vertexes_) {
-      if (this->allowed_colors_[vertex].empty()) {
+      if (this->allowed_colors_of_(vertex).empty()) {
         return true;
       }
     }
@@ -345,21 +549,196 @@ class BaseColoringSSS: public BaseSSS<a, 2> {
     return false;
   }
 
+  // Colors the vertexes removed by drop_small_color_vertexes() since the first `from` records,
+  // latest first: a 2-color vertex takes its first color unless a constraint of it is violated.
+  void restore_eliminated(std::map<Vertex, Color>& coloring, size_t from = 0) {
+    for (size_t i = eliminated_.size(); i > from; --i) {
+      auto& elimination = eliminated_[i - 1];
+      Color color = elimination.color;
+
+      for (auto& pair: elimination.conflicts) {
+        auto it = coloring.find(pair.vertex);
+        if (it != coloring.end() && it->second == pair.color) {
+          color = elimination.other_color;
+          break;
+        }
+      }
+
+      coloring[elimination.vertex] = color;
+    }
+
+    eliminated_.resize(from);
+  }
+
+  size_t num_eliminated() const {
+    return eliminated_.size();
+  }
+
+  // Extends a partial coloring to all vertexes by backtracking over allowed colors and constraints.
+  bool complete_coloring(std::map<Vertex, Color>& coloring) {
+    std::map<Pair, std::vector<Pair>> conflicts;
+    for (auto& constraint: this->constraints_) {
+      auto it = constraint.begin();
+      conflicts[*it].push_back(*std::next(it));
+      conflicts[*std::next(it)].push_back(*it);
+    }
+
+    std::vector<Vertex> free;
+    for (auto vertex: this->vertexes_) {
+      if (!coloring.contains(vertex)) {
+        free.push_back(vertex);
+      }
+    }
+
+    return complete_coloring_(coloring, conflicts, free, 0);
+  }
+
+  // True if renaming c1 <-> c2 everywhere maps the instance onto itself: then a vertex that can't
+  // take c1 can't take c2 either.
+  bool is_symmetric_under_swap(Color c1, Color c2) const {
+    auto swap = [&](const Pair& pair) -> Pair {
+      return {pair.vertex, pair.color == c1 ? c2 : (pair.color == c2 ? c1 : pair.color)};
+    };
+
+    for (auto vertex: this->vertexes_) {
+      auto& colors = this->allowed_colors_of_(vertex);
+      if (colors.contains(c1) != colors.contains(c2)) {
+        return false;
+      }
+    }
+
+    for (auto& constraint: this->constraints_) {
+      PoolSet<Pair> swapped;
+      for (auto& pair: constraint) {
+        swapped.insert(swap(pair));
+      }
+      if (!this->constraints_.contains(Constraint(std::move(swapped)))) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool is_valid_coloring(const std::map<Vertex, Color>& coloring) {
+    for (auto vertex: this->vertexes_) {
+      auto it = coloring.find(vertex);
+      if (it == coloring.end() || !this->is_allow_color({vertex, it->second})) {
+        return false;
+      }
+    }
+
+    for (auto& constraint: this->constraints_) {
+      bool all = true;
+      for (auto& pair: constraint) {
+        auto it = coloring.find(pair.vertex);
+        all &= it != coloring.end() && it->second == pair.color;
+      }
+      if (all) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
  protected:
-  static Pair get_other_pair(Constraint constraint, const Pair& pair) {
-    constraint.erase(pair);
-    return *constraint.begin();
+  struct Elimination {
+    Vertex vertex;
+    Color color;
+    Color other_color;
+    std::vector<Pair> conflicts;
+  };
+
+  static Pair get_other_pair(const Constraint& constraint, const Pair& pair) {
+    return *constraint.begin() == pair ? *std::next(constraint.begin()) : *constraint.begin();
   }
+
+  bool complete_coloring_(std::map<Vertex, Color>& coloring, std::map<Pair, std::vector<Pair>>& conflicts,
+                          const std::vector<Vertex>& free, size_t index) {
+    if (index == free.size()) {
+      return true;
+    }
+
+    Vertex vertex = free[index];
+    for (auto color: this->allowed_colors_of_(vertex)) {
+      bool possible = true;
+      for (auto& pair: conflicts[{vertex, color}]) {
+        auto it = coloring.find(pair.vertex);
+        possible &= it == coloring.end() || it->second != pair.color;
+      }
+
+      if (possible) {
+        coloring[vertex] = color;
+        if (complete_coloring_(coloring, conflicts, free, index + 1)) {
+          return true;
+        }
+        coloring.erase(vertex);
+      }
+    }
+
+    return false;
+  }
+
+  std::vector<Elimination> eliminated_;
 };
 
 
 template<size_t a>
 class SSS<a, 2>: public BaseColoringSSS<a> {};
 
+// Limit on the solve() calls of one SSS<3, 2> search, copies included.
+struct NodeBudget {
+  uint64_t limit = UINT64_MAX;
+  uint64_t used = 0;
+};
+
+class NodeBudgetExceeded: public std::runtime_error {
+ public:
+  NodeBudgetExceeded(): std::runtime_error("Node budget exceeded") {}
+};
+
 template<>
 class SSS<3, 2>: public BaseColoringSSS<3> {
  public:
+  SSS() = default;
+  // A branch copy leaves out the pair maps: they are rebuilt from the constraints before use.
+  SSS(const SSS& other): BaseColoringSSS<3>(other), budget_(other.budget_), answer(other.answer), coloring(other.coloring) {}
+  SSS& operator=(const SSS&) = default;
+  SSS(SSS&&) noexcept = default;
+  SSS& operator=(SSS&&) noexcept = default;
+
+  // solve() that counts its nodes in budget; nullopt when it runs out, the state is spent then.
+  std::optional<bool> solve(NodeBudget& budget) {
+    budget_ = &budget;
+    std::optional<bool> ans;
+    try {
+      ans = solve();
+    } catch (const NodeBudgetExceeded&) {
+    }
+    budget_ = nullptr;
+    return ans;
+  }
+
   bool solve() {
+    Deadline::check();
+    SearchProgress::node();
+    if (budget_ != nullptr && ++budget_->used > budget_->limit) {
+      throw NodeBudgetExceeded();
+    }
+    size_t eliminated = num_eliminated();
+    bool ans = solve_reduced_();
+
+    if (ans) {
+      restore_eliminated(coloring, eliminated);
+    } else {
+      eliminated_.resize(eliminated);
+    }
+    return ans;
+  }
+
+ private:
+  bool solve_reduced_() {
     if (has_uncolored_vertex()) {
       return false;
     }
@@ -376,35 +755,42 @@ class SSS<3, 2>: public BaseColoringSSS<3> {
 
     recalculate_pair_maps_();
 
+    // cases get a copy of the pair: they recalculate the maps that item.first points into
     for (auto& item: pair_vertexes_constr_) {
       if (item.second.size() >= 3) {
-        return case_3_different_vertexes_(item.first);
+        Pair pair = item.first;
+        TraceSpan span("case_3_different_vertexes", TraceSpan::Kind::kSearch);
+        return case_3_different_vertexes_(pair);
       }
     }
 
     for (auto& item: pair_constraints_) {
+      Pair pair = item.first;
       if (item.second.size() == 1) {
-        return case_only_1_constraint_(item.first);
+        TraceSpan span("case_only_1_constraint", TraceSpan::Kind::kSearch);
+        return case_only_1_constraint_(pair);
       }
 
       if (item.second.empty()) {
-        return case_0_constraint_(item.first);
+        TraceSpan span("case_0_constraint", TraceSpan::Kind::kSearch);
+        return case_0_constraint_(pair);
       }
     }
 
     for (auto& item: pair_constraints_) {
       if (item.second.size() >= 3) {
-        return case_3_different_constraints_(item.first);
+        Pair pair = item.first;
+        TraceSpan span("case_3_different_constraints", TraceSpan::Kind::kSearch);
+        return case_3_different_constraints_(pair);
       }
     }
 
+    TraceSpan span("case_2_different_constraints", TraceSpan::Kind::kSearch);
     return case_2_different_constraints_();
   }
 
- private:
-  static Pair get_other_pair(Constraint constraint, const Pair& pair) {
-    constraint.erase(pair);
-    return *constraint.begin();
+  static Pair get_other_pair(const Constraint& constraint, const Pair& pair) {
+    return *constraint.begin() == pair ? *std::next(constraint.begin()) : *constraint.begin();
   }
 
   template<class Iterable>
@@ -417,25 +803,25 @@ class SSS<3, 2>: public BaseColoringSSS<3> {
     return {c1, c2};
   }
 
-  std::pair<Pair, Pair> get_adj_pairs(const Pair& pair) {
-    auto colors = colors_;
-    colors.erase(pair.color);
+  using Colors = ColorTable<3>;
 
-    auto [c1, c2] = unpack_two_elems(colors);
+  static std::pair<Pair, Pair> get_adj_pairs(const Pair& pair) {
+    auto [c1, c2] = Colors::other_two[pair.color];
     return {{pair.vertex, c1}, {pair.vertex, c2}};
   }
-  Pair get_adj_pair(const Pair& pair1, const Pair& pair2) {
-    auto colors = colors_;
-    colors.erase(pair1.color);
-    colors.erase(pair2.color);
-
-    auto c = *colors.begin();
-    return {pair1.vertex, c};
+  static Pair get_adj_pair(const Pair& pair1, const Pair& pair2) {
+    return {pair1.vertex, Colors::first_missing[Colors::mask(pair1.color) | Colors::mask(pair2.color)]};
   }
 
+  // pair_constraints_ may be stale here (some cases drop colors before coloring), so the
+  // constraints are looked up again and the other pairs collected before any of them is erased
   void color_vertex(const Pair& pair) {
-    for (auto& it: pair_constraints_[pair]) {
-      auto other_pair = get_other_pair(*it, pair);
+    std::vector<Pair> other_pairs;
+    for (auto& constraint: get_constraints(pair)) {
+      other_pairs.push_back(get_other_pair(constraint, pair));
+    }
+
+    for (auto& other_pair: other_pairs) {
       drop_allow_color(other_pair);
     }
     drop_vertex(pair.vertex);
@@ -479,7 +865,16 @@ class SSS<3, 2>: public BaseColoringSSS<3> {
       return true;
     }
 
-    drop_allow_color(pair);
+    // colors in the orbit of the failed one fail too
+    std::vector<Pair> failed = {pair};
+    for (auto color: colors_) {
+      if (color != pair.color && is_allow_color({pair.vertex, color}) && is_symmetric_under_swap(pair.color, color)) {
+        failed.push_back({pair.vertex, color});
+      }
+    }
+    for (auto& failed_pair: failed) {
+      drop_allow_color(failed_pair);
+    }
 //    drop_2_colors_vertexes();
 
     return solve();
@@ -597,7 +992,7 @@ class SSS<3, 2>: public BaseColoringSSS<3> {
         std::cerr << "They must be equal (2)!" << std::endl;
       }
 
-      auto colors = this->allowed_colors_[pairs_x[0].vertex];
+      auto colors = this->allowed_colors_of_(pairs_x[0].vertex);
       colors.erase(pairs_x[0].color);
       colors.erase(pairs_x[1].color);
 
@@ -610,7 +1005,9 @@ class SSS<3, 2>: public BaseColoringSSS<3> {
 
     if (possible_colors.size() == 1) {
       auto [v, set_colors] = *possible_colors.begin();
-      for (auto color: this->allowed_colors_[v]) {
+      // a copy: drop_allow_color() erases from the set of v
+      auto colors = this->allowed_colors_of_(v);
+      for (auto color: colors) {
         if (!set_colors.contains(color)) {
           drop_allow_color({v, color});
         }
@@ -625,11 +1022,11 @@ class SSS<3, 2>: public BaseColoringSSS<3> {
       ++it;
       auto [v2, set_colors2] = *it;
 
-      for (auto color1: this->allowed_colors_[v1]) {
+      for (auto color1: this->allowed_colors_of_(v1)) {
         if (set_colors1.contains(color1)) {
           continue;
         }
-        for (auto color2: this->allowed_colors_[v2]) {
+        for (auto color2: this->allowed_colors_of_(v2)) {
           if (set_colors2.contains(color2)) {
             continue;
           }
@@ -639,10 +1036,52 @@ class SSS<3, 2>: public BaseColoringSSS<3> {
       }
     }
 
+    // v and w are colored after the rest, against the constraints they have now
+    std::map<Pair, std::vector<Pair>> conflicts;
+    for (auto vertex: {pair_v.vertex, pair_w.vertex}) {
+      for (auto color: this->allowed_colors_of_(vertex)) {
+        auto& others = conflicts[{vertex, color}];
+        for (auto& constraint: get_constraints({vertex, color})) {
+          others.push_back(get_other_pair(constraint, {vertex, color}));
+        }
+      }
+    }
+
     drop_vertex(pair_v.vertex);
     drop_vertex(pair_w.vertex);
 
-    return solve();
+    if (!solve()) {
+      return false;
+    }
+    color_dropped_(pair_v.vertex, pair_w.vertex, conflicts);
+    return true;
+  }
+
+  // The colors of two dropped vertexes that no constraint forbids with the coloring of the rest.
+  void color_dropped_(Vertex v, Vertex w, const std::map<Pair, std::vector<Pair>>& conflicts) {
+    auto is_free = [&](const Pair& pair) {
+      for (auto& other: conflicts.at(pair)) {
+        auto it = coloring.find(other.vertex);
+        if (it != coloring.end() && it->second == other.color) {
+          return false;
+        }
+      }
+      return true;
+    };
+
+    for (auto& [pair_v, _]: conflicts) {
+      if (pair_v.vertex != v || !is_free(pair_v)) {
+        continue;
+      }
+      coloring[v] = pair_v.color;
+      for (auto& [pair_w, _]: conflicts) {
+        if (pair_w.vertex == w && is_free(pair_w)) {
+          coloring[w] = pair_w.color;
+          return;
+        }
+      }
+    }
+    throw std::runtime_error("SSS<3, 2>: no colors left for vertexes " + std::to_string(v) + " and " + std::to_string(w));
   }
 
   bool case_2_c(const Pair& pair_v, const Pair& pair_w) {
@@ -911,11 +1350,9 @@ class SSS<3, 2>: public BaseColoringSSS<3> {
 
   bool case_4_a(const std::vector<Pair>& path) {
     auto copy = *this;
-    copy.drop_vertex(path[0].vertex);
-    copy.drop_vertex(path[3].vertex);
-    copy.drop_allow_color(path[1]);
-    copy.drop_allow_color(path[2]);
-    copy.drop_allow_color(path[4]);
+    // A is also constrained with a pair outside of the path, so it is colored as a whole
+    copy.color_vertex(path[0]);
+    copy.color_vertex(path[3]);
 //    copy.drop_2_colors_vertexes();
 
     if (copy.solve()) {
@@ -1044,7 +1481,7 @@ class SSS<3, 2>: public BaseColoringSSS<3> {
 
   bool case_2_different_constraints_() {
     for (auto vertex: vertexes_) {
-      for (auto color: allowed_colors_[vertex]) {
+      for (auto color: allowed_colors_of_(vertex)) {
         Pair pair = {vertex, color};
         if (!pair_constraints_.contains(pair) || pair_constraints_[pair].empty()) {
           drop_vertex(vertex);
@@ -1125,13 +1562,77 @@ class SSS<3, 2>: public BaseColoringSSS<3> {
     }
 
     // all: A-B-C-A
+    return color_triangles_();
+  }
+
+  // Every pair is in two constraints that close a triangle A-B-C-A on three vertexes. A coloring
+  // takes one pair per vertex and at most one per triangle: a perfect matching of the bipartite
+  // graph of vertexes and triangles, 3-regular, so Hall's condition holds. Kuhn's augmenting paths.
+  bool color_triangles_() {
+    std::map<Pair, size_t> triangle;
+    size_t triangles = 0;
+    for (auto& [start, _]: pair_constraints_) {
+      if (triangle.contains(start)) {
+        continue;
+      }
+      std::vector<Pair> stack = {start};
+      triangle[start] = triangles;
+      while (!stack.empty()) {
+        Pair pair = stack.back();
+        stack.pop_back();
+        for (auto& it: pair_constraints_[pair]) {
+          Pair other = get_other_pair(*it, pair);
+          if (triangle.emplace(other, triangles).second) {
+            stack.push_back(other);
+          }
+        }
+      }
+      ++triangles;
+    }
+
+    std::vector<Vertex> vertexes(vertexes_.begin(), vertexes_.end());
+    std::vector<std::vector<Pair>> options(vertexes.size());
+    for (size_t i = 0; i < vertexes.size(); ++i) {
+      for (auto color: allowed_colors_of_(vertexes[i])) {
+        options[i].push_back({vertexes[i], color});
+      }
+    }
+
+    constexpr size_t kFree = -1;
+    std::vector<size_t> owner(triangles, kFree), seen(triangles, kFree);
+    std::vector<Pair> chosen(vertexes.size());
+    std::function<bool(size_t, size_t)> augment = [&](size_t i, size_t stamp) {
+      for (auto& pair: options[i]) {
+        size_t t = triangle.at(pair);
+        if (seen[t] == stamp) {
+          continue;
+        }
+        seen[t] = stamp;
+        if (owner[t] == kFree || augment(owner[t], stamp)) {
+          owner[t] = i;
+          chosen[i] = pair;
+          return true;
+        }
+      }
+      return false;
+    };
+    for (size_t i = 0; i < vertexes.size(); ++i) {
+      if (!augment(i, i)) {
+        throw std::runtime_error("SSS<3, 2>: no pair of vertex " + std::to_string(vertexes[i]) + " is free of its triangles");
+      }
+    }
+
+    for (auto& pair: chosen) {
+      coloring[pair.vertex] = pair.color;
+    }
     return true;
   }
 
   //-----------------------------------------------
 
-  std::map<Pair, std::set<Constraints_iterator>> pair_constraints_;
-  std::map<Pair, std::set<Vertex>> pair_vertexes_constr_;
+  PoolMap<Pair, PoolSet<Constraints_iterator>> pair_constraints_;
+  PoolMap<Pair, PoolSet<Vertex>> pair_vertexes_constr_;
+  NodeBudget* budget_ = nullptr;  // copies of the branches share it
 
   bool answer = true;
 
@@ -1139,4 +1640,161 @@ class SSS<3, 2>: public BaseColoringSSS<3> {
   std::map<Vertex, Color> coloring;
 };
 
+struct RandomizedOptions {
+  double error_bound = 1e-9;  // probability to answer "no" for a solvable instance
+  size_t max_trials = 0;      // 0 - as many as error_bound needs
+  size_t threads = 1;
+  uint64_t seed = 311001;
+};
+
+// Beigel-Eppstein reduction of (4,2)-CSP: every 4-color domain loses one random color and the
+// resulting (3,2)-CSP goes to SSS<3, 2>. A trial keeps a fixed solution with probability at least
+// (3/4)^k for k vertexes with 4 colors, so (4/3)^k * ln(1 / error_bound) trials give O(1.8^n).
+template<>
+class SSS<4, 2>: public BaseColoringSSS<4> {
+ public:
+  bool solve(const RandomizedOptions& options = {}) {
+    size_t eliminated = num_eliminated();
+    drop_small_color_vertexes();
+    if (has_uncolored_vertex()) {
+      eliminated_.resize(eliminated);
+      return false;
+    }
+
+    std::vector<std::pair<Vertex, std::vector<Color>>> domains;
+    size_t num_4_colors = 0;
+    for (auto vertex: vertexes_) {
+      auto& colors = allowed_colors_of_(vertex);
+      domains.emplace_back(vertex, std::vector<Color>(colors.begin(), colors.end()));
+      num_4_colors += colors.size() == 4;
+    }
+    std::vector<std::pair<Pair, Pair>> constraints;
+    for (auto& constraint: constraints_) {
+      constraints.emplace_back(*constraint.begin(), *std::next(constraint.begin()));
+    }
+
+    size_t trials = num_trials_(num_4_colors, options);
+    std::atomic<size_t> next_trial = 0;
+    std::atomic<bool> found = false;
+    std::mutex mutex;
+    std::exception_ptr error;
+
+    auto worker = [&](size_t index) {
+      std::mt19937_64 random(options.seed + index);
+      try {
+        while (!found && next_trial++ < trials) {
+          std::map<Vertex, Color> trial_coloring;
+          if (trial_(domains, constraints, random, trial_coloring)) {
+            std::lock_guard lock(mutex);
+            if (!found) {
+              coloring = std::move(trial_coloring);
+              found = true;
+            }
+          }
+        }
+      } catch (...) {
+        std::lock_guard lock(mutex);
+        error = error ? error : std::current_exception();
+        found = true;
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < std::min(options.threads, trials); ++i) {
+      threads.emplace_back(worker, i);
+    }
+    worker(0);
+    for (auto& thread: threads) {
+      thread.join();
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+
+    if (found) {
+      restore_eliminated(coloring, eliminated);
+    } else {
+      eliminated_.resize(eliminated);
+    }
+    return found;
+  }
+
+ private:
+  static size_t num_trials_(size_t num_4_colors, const RandomizedOptions& options) {
+    if (num_4_colors == 0) {
+      return 1;
+    }
+
+    double success = std::pow(0.75, static_cast<double>(num_4_colors));
+    double trials = std::ceil(std::log(1 / options.error_bound) / success);
+    if (options.max_trials != 0) {
+      trials = std::min(trials, static_cast<double>(options.max_trials));
+    }
+
+    return trials >= static_cast<double>(SIZE_MAX) ? SIZE_MAX : std::max<size_t>(1, static_cast<size_t>(trials));
+  }
+
+  static bool trial_(const std::vector<std::pair<Vertex, std::vector<Color>>>& domains,
+                     const std::vector<std::pair<Pair, Pair>>& constraints,
+                     std::mt19937_64& random, std::map<Vertex, Color>& result) {
+    SSS<3, 2> sss;
+    std::map<Vertex, std::vector<Color>> local_colors;
+    std::map<Vertex, std::set<Color>> allowed;
+
+    for (auto& [vertex, colors]: domains) {
+      auto& local = local_colors[vertex];
+      local = colors;
+      if (local.size() == 4) {
+        local.erase(local.begin() + static_cast<std::ptrdiff_t>(random() % 4));
+      }
+
+      for (Color c = 0; c < local.size(); ++c) {
+        allowed[vertex].insert(c);
+      }
+      sss.add_vertexes({vertex});
+    }
+    sss.set_allow_colors(allowed);
+
+    auto to_local = [&](const Pair& pair) -> std::optional<Pair> {
+      auto& local = local_colors[pair.vertex];
+      auto it = std::find(local.begin(), local.end(), pair.color);
+      if (it == local.end()) {
+        return std::nullopt;
+      }
+      return Pair{pair.vertex, static_cast<Color>(it - local.begin())};
+    };
+
+    for (auto& [pair1, pair2]: constraints) {
+      auto local1 = to_local(pair1);
+      auto local2 = to_local(pair2);
+      if (local1 && local2) {
+        sss.add_constraint({*local1, *local2});
+      }
+    }
+
+    if (!sss.solve()) {
+      return false;
+    }
+
+    // the witness of SSS<3, 2> colors every vertex; checked in O(n + m) against the 4-color instance
+    for (auto& [vertex, colors]: domains) {
+      auto it = sss.coloring.find(vertex);
+      auto& local = local_colors[vertex];
+      if (it == sss.coloring.end() || it->second >= local.size()) {
+        throw std::runtime_error("SSS<3, 2> left vertex " + std::to_string(vertex) + " uncolored");
+      }
+      result[vertex] = local[it->second];
+    }
+    for (auto& [pair1, pair2]: constraints) {
+      if (result[pair1.vertex] == pair1.color && result[pair2.vertex] == pair2.color) {
+        throw std::runtime_error("SSS<3, 2> returned a coloring that violates a constraint");
+      }
+    }
+    return true;
+  }
+
+ public:
+  std::map<Vertex, Color> coloring;
+};
+
 #endif //INC_3COLORING__SSS_H_
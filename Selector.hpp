@@ -0,0 +1,300 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__SELECTOR_HPP_
+#define INC_3COLORING__SELECTOR_HPP_
+
+#include "Coloring.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+enum class Engine {
+  kFast,               // ColoringSolver::solve()
+  kStupid,             // ColoringSolver::stupid_solve()
+  kTreeDecomposition,  // ColoringSolver::solve_tree_decomposition(), chosen by width, not by the cost model
+};
+
+// engines timed by the cost model
+inline constexpr std::array<Engine, 2> kEngines = {Engine::kFast, Engine::kStupid};
+
+// graphs of at most this estimated treewidth go to the tree decomposition
+inline constexpr size_t kTreeDecompositionWidth = 8;
+
+inline std::string engine_name(Engine engine) {
+  switch (engine) {
+    case Engine::kFast:
+      return "fast";
+    case Engine::kStupid:
+      return "stupid";
+    case Engine::kTreeDecomposition:
+      return "treewidth";
+  }
+  return "";
+}
+
+inline bool run_engine(ColoringSolver& solver, Engine engine) {
+  switch (engine) {
+    case Engine::kFast:
+      return solver.solve();
+    case Engine::kStupid:
+      return solver.stupid_solve();
+    case Engine::kTreeDecomposition:
+      return solver.solve_tree_decomposition();
+  }
+  return false;
+}
+
+// log(seconds) = weights * x(features), one weight vector per engine.
+class CostModel {
+ public:
+  static constexpr size_t kFeatures = 7;
+  using Weights = std::array<double, kFeatures>;
+
+  static std::array<double, kFeatures> feature_vector(const GraphFeatures& features) {
+    return {1.0,
+            static_cast<double>(features.n),
+            std::log1p(static_cast<double>(features.n)),
+            static_cast<double>(features.core_size),
+            static_cast<double>(features.seeds),
+            features.density,
+            std::log1p(static_cast<double>(features.max_degree))};
+  }
+
+  // Rough fit of both engines on random graphs, used until the machine is calibrated.
+  static CostModel defaults() {
+    CostModel model;
+    model.weights_[size_t(Engine::kFast)] = {-23.8, -0.517, 9.11, 0.248, -0.307, 4.18, -2.24};
+    model.weights_[size_t(Engine::kStupid)] = {-11.5, 0.197, 0.328, 0.131, 0.784, -2.39, -0.360};
+    return model;
+  }
+
+  double predict(Engine engine, const GraphFeatures& features) const {
+    auto x = feature_vector(features);
+    auto& w = weights_[size_t(engine)];
+
+    double log_time = 0;
+    for (size_t i = 0; i < kFeatures; ++i) {
+      log_time += w[i] * x[i];
+    }
+    return std::exp(log_time);
+  }
+
+  Engine choose(const GraphFeatures& features) const {
+    if (features.width <= kTreeDecompositionWidth) {
+      return Engine::kTreeDecomposition;
+    }
+
+    Engine best = kEngines[0];
+    for (auto engine: kEngines) {
+      if (predict(engine, features) < predict(best, features)) {
+        best = engine;
+      }
+    }
+    return best;
+  }
+
+  Weights& weights(Engine engine) {
+    return weights_[size_t(engine)];
+  }
+  const Weights& weights(Engine engine) const {
+    return weights_[size_t(engine)];
+  }
+
+  // $COLORING_PROFILE, or 3coloring.profile in the working directory
+  static std::string default_path() {
+    const char* path = std::getenv("COLORING_PROFILE");
+    return path != nullptr ? path : "3coloring.profile";
+  }
+
+  // Missing profile gives defaults(), a malformed one throws.
+  static CostModel load(const std::string& path = default_path()) {
+    CostModel model = defaults();
+    std::ifstream file(path);
+    if (!file) {
+      return model;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+      if (line.empty() || line[0] == '#') {
+        continue;
+      }
+
+      std::istringstream stream(line);
+      std::string name;
+      stream >> name;
+      auto engine = std::find_if(kEngines.begin(), kEngines.end(), [&](Engine e) {
+        return engine_name(e) == name;
+      });
+      if (engine == kEngines.end()) {
+        throw std::runtime_error("Unknown engine " + name + " in profile " + path);
+      }
+
+      for (auto& weight: model.weights(*engine)) {
+        if (!(stream >> weight)) {
+          throw std::runtime_error("Profile " + path + " has too few weights for " + name);
+        }
+      }
+    }
+
+    return model;
+  }
+
+  void save(const std::string& path = default_path()) const {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+      throw std::runtime_error("Can't create file " + path);
+    }
+
+    file << "# engine, weights of 1 n log(1+n) core seeds density log(1+max_degree) -> log(seconds)\n";
+    file.precision(9);
+    for (auto engine: kEngines) {
+      file << engine_name(engine);
+      for (auto weight: weights(engine)) {
+        file << ' ' << weight;
+      }
+      file << '\n';
+    }
+  }
+
+ private:
+  std::array<Weights, kEngines.size()> weights_{};
+};
+
+// Times every engine on random G(n, p) graphs and fits the cost model by least squares.
+class Calibrator {
+ public:
+  struct Options {
+    size_t max_n = 24;
+    size_t repeats = 2;
+    uint64_t seed = 311001;
+    double min_time = 1e-3;  // small graphs are solved repeatedly until this many seconds pass
+  };
+
+  explicit Calibrator(Options options): options_(options) {}
+  Calibrator(): Calibrator(Options{}) {}
+
+  CostModel run(std::ostream* log = nullptr) const {
+    std::mt19937_64 random(options_.seed);
+    std::vector<std::array<double, CostModel::kFeatures>> xs;
+    std::array<std::vector<double>, kEngines.size()> ys;
+
+    for (size_t n = 6; n <= options_.max_n; n += 3) {
+      for (double degree: {1.5, 3.0, 4.5, 6.0, 9.0}) {
+        if (degree >= static_cast<double>(n - 1)) {
+          continue;
+        }
+
+        for (size_t repeat = 0; repeat < options_.repeats; ++repeat) {
+          auto solver = random_graph_(n, degree / static_cast<double>(n - 1), random);
+          auto features = solver.features();
+          xs.push_back(CostModel::feature_vector(features));
+
+          for (auto engine: kEngines) {
+            double seconds = time_(solver, engine);
+            ys[size_t(engine)].push_back(std::log(seconds));
+            if (log != nullptr) {
+              *log << "n=" << n << " degree=" << degree << " core=" << features.core_size
+                   << " seeds=" << features.seeds << " " << engine_name(engine) << "=" << seconds << "s\n";
+            }
+          }
+        }
+      }
+    }
+
+    CostModel model;
+    for (auto engine: kEngines) {
+      model.weights(engine) = fit_(xs, ys[size_t(engine)]);
+    }
+    return model;
+  }
+
+ private:
+  static ColoringSolver random_graph_(size_t n, double p, std::mt19937_64& random) {
+    std::bernoulli_distribution edge(p);
+    ColoringSolver solver;
+    solver.create_vertexes(n);
+    solver.add_all_colors();
+
+    for (Vertex v = 0; v < n; ++v) {
+      for (Vertex u = v + 1; u < n; ++u) {
+        if (edge(random)) {
+          solver.add_edge(v, u);
+        }
+      }
+    }
+
+    return solver;
+  }
+
+  double time_(const ColoringSolver& solver, Engine engine) const {
+    using Clock = std::chrono::steady_clock;
+    size_t runs = 0;
+    auto begin = Clock::now();
+    double elapsed = 0;
+
+    while (elapsed < options_.min_time) {
+      auto copy = solver;
+      run_engine(copy, engine);
+      ++runs;
+      elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+    }
+
+    return elapsed / static_cast<double>(runs);
+  }
+
+  // Ridge-regularized normal equations, solved by Gaussian elimination with partial pivoting.
+  static CostModel::Weights fit_(const std::vector<std::array<double, CostModel::kFeatures>>& xs,
+                                 const std::vector<double>& ys) {
+    constexpr size_t k = CostModel::kFeatures;
+    constexpr double kRidge = 1e-6;
+    std::array<std::array<double, k + 1>, k> a{};
+
+    for (size_t s = 0; s < xs.size(); ++s) {
+      for (size_t i = 0; i < k; ++i) {
+        for (size_t j = 0; j < k; ++j) {
+          a[i][j] += xs[s][i] * xs[s][j];
+        }
+        a[i][k] += xs[s][i] * ys[s];
+      }
+    }
+    for (size_t i = 0; i < k; ++i) {
+      a[i][i] += kRidge * (1.0 + a[i][i]);
+    }
+
+    for (size_t col = 0; col < k; ++col) {
+      size_t pivot = col;
+      for (size_t row = col + 1; row < k; ++row) {
+        if (std::abs(a[row][col]) > std::abs(a[pivot][col])) {
+          pivot = row;
+        }
+      }
+      std::swap(a[col], a[pivot]);
+      if (a[col][col] == 0) {
+        continue;
+      }
+
+      for (size_t row = 0; row < k; ++row) {
+        if (row != col) {
+          double factor = a[row][col] / a[col][col];
+          for (size_t j = col; j <= k; ++j) {
+            a[row][j] -= factor * a[col][j];
+          }
+        }
+      }
+    }
+
+    CostModel::Weights weights{};
+    for (size_t i = 0; i < k; ++i) {
+      weights[i] = a[i][i] == 0 ? 0 : a[i][k] / a[i][i];
+    }
+    return weights;
+  }
+
+  Options options_;
+};
+
+#endif //INC_3COLORING__SELECTOR_HPP_
@@ -0,0 +1,324 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__TABU_HPP_
+#define INC_3COLORING__TABU_HPP_
+
+#include "Graph.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+
+struct TabuOptions {
+  double seconds = 10;                     // wall-clock budget for the whole search
+  size_t iterations_per_restart = 10000000;
+  size_t max_restarts = 0;                 // per thread, 0 means until the time runs out
+  size_t threads = 1;
+  uint64_t seed = 311001;
+  size_t tenure_base = 10;                 // tabu tenure is base + random(0..9) + factor * |conflicting|
+  double tenure_factor = 0.6;
+};
+
+// TabuCol (Hertz, de Werra) for 3 colors: moves a conflicting vertex to the color that lowers the
+// number of conflicting edges most, forbidding the old color of that vertex for a while.
+// Works on the degree <= 2 peeled core; peeled vertexes are colored back in reverse order.
+// Incomplete: finds colorings of colorable graphs, never proves that there is none.
+class TabuSearch {
+ public:
+  static constexpr size_t kColors = 3;
+
+  explicit TabuSearch(GraphView graph, TabuOptions options = {}): graph_(graph), options_(options) {}
+
+  // A verified coloring, or nullopt if none was found within the budget.
+  std::optional<Coloring> run() {
+    for (Vertex v = 0; v < graph_.n; ++v) {
+      auto adjacent = graph_.adjacent(v);
+      if (std::binary_search(adjacent.begin(), adjacent.end(), v)) {
+        return std::nullopt;
+      }
+    }
+
+    deadline_ = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(options_.seconds));
+    found_ = false;
+    make_core_();
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < std::max<size_t>(options_.threads, 1); ++i) {
+      workers.emplace_back([this, i] { search_(i); });
+    }
+    search_(0);
+    for (auto& worker: workers) {
+      worker.join();
+    }
+
+    if (!found_) {
+      return std::nullopt;
+    }
+
+    std::vector<Color> colors(graph_.n, kColors);
+    for (size_t i = 0; i < core_vertexes_.size(); ++i) {
+      colors[core_vertexes_[i]] = result_[i];
+    }
+    for (auto it = peeled_.rbegin(); it != peeled_.rend(); ++it) {
+      std::array<bool, kColors> used = {false, false, false};
+      for (auto u: graph_.adjacent(*it)) {
+        if (colors[u] != kColors) {
+          used[colors[u]] = true;
+        }
+      }
+      colors[*it] = static_cast<Color>(std::find(used.begin(), used.end(), false) - used.begin());
+    }
+
+    if (!is_valid_(graph_, colors)) {
+      return std::nullopt;
+    }
+
+    Coloring coloring;
+    for (Vertex v = 0; v < graph_.n; ++v) {
+      coloring.insert(coloring.end(), {v, colors[v]});
+    }
+    return coloring;
+  }
+
+  size_t iterations() const {
+    return iterations_;
+  }
+  size_t restarts() const {
+    return restarts_;
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  // State of one restart: colors, gamma (neighbours per color) and the conflicting vertexes.
+  class Run {
+   public:
+    Run(GraphView graph, std::mt19937_64& random): graph_(graph), random_(random),
+        color_(graph.n), gamma_(graph.n, {0, 0, 0}), tabu_(graph.n, {0, 0, 0}),
+        position_(graph.n, kNone) {
+      // greedy start in random order: each vertex takes its least conflicting color
+      std::vector<Vertex> order(graph.n);
+      for (Vertex v = 0; v < graph.n; ++v) {
+        order[v] = v;
+      }
+      std::shuffle(order.begin(), order.end(), random_);
+
+      std::vector<bool> placed(graph.n, false);
+      for (auto v: order) {
+        std::array<size_t, kColors> used = {0, 0, 0};
+        for (auto u: graph.adjacent(v)) {
+          if (placed[u]) {
+            ++used[color_[u]];
+          }
+        }
+        color_[v] = static_cast<Color>(std::min_element(used.begin(), used.end()) - used.begin());
+        placed[v] = true;
+      }
+
+      for (Vertex v = 0; v < graph.n; ++v) {
+        for (auto u: graph.adjacent(v)) {
+          ++gamma_[v][color_[u]];
+        }
+        conflicts_ += gamma_[v][color_[v]];
+        update_conflicting_(v);
+      }
+      conflicts_ /= 2;
+    }
+
+    size_t conflicts() const {
+      return conflicts_;
+    }
+    const std::vector<Color>& colors() const {
+      return color_;
+    }
+
+    // Returns false if every move is tabu.
+    bool step(size_t iteration, const TabuOptions& options) {
+      long best_delta = std::numeric_limits<long>::max();
+      Vertex best_vertex = 0;
+      Color best_color = 0;
+      size_t ties = 0;
+
+      for (auto v: conflicting_) {
+        auto& gamma = gamma_[v];
+        for (Color c = 0; c < kColors; ++c) {
+          if (c == color_[v]) {
+            continue;
+          }
+
+          long delta = static_cast<long>(gamma[c]) - static_cast<long>(gamma[color_[v]]);
+          bool aspiration = static_cast<long>(conflicts_) + delta < static_cast<long>(best_conflicts_);
+          if (tabu_[v][c] > iteration && !aspiration) {
+            continue;
+          }
+
+          if (delta < best_delta) {
+            best_delta = delta;
+            best_vertex = v;
+            best_color = c;
+            ties = 1;
+          } else if (delta == best_delta && random_() % ++ties == 0) {
+            best_vertex = v;
+            best_color = c;
+          }
+        }
+      }
+
+      if (ties == 0) {
+        return false;
+      }
+
+      tabu_[best_vertex][color_[best_vertex]] = iteration + options.tenure_base + random_() % 10 +
+          static_cast<size_t>(options.tenure_factor * static_cast<double>(conflicting_.size()));
+      move_(best_vertex, best_color);
+      best_conflicts_ = std::min(best_conflicts_, conflicts_);
+      return true;
+    }
+
+   private:
+    static constexpr size_t kNone = std::numeric_limits<size_t>::max();
+
+    void move_(Vertex v, Color color) {
+      Color old = color_[v];
+      conflicts_ = conflicts_ + gamma_[v][color] - gamma_[v][old];
+      color_[v] = color;
+
+      for (auto u: graph_.adjacent(v)) {
+        --gamma_[u][old];
+        ++gamma_[u][color];
+        update_conflicting_(u);
+      }
+      update_conflicting_(v);
+    }
+
+    // keeps v in conflicting_ iff some neighbour shares its color, O(1)
+    void update_conflicting_(Vertex v) {
+      bool conflicting = gamma_[v][color_[v]] != 0;
+      if (conflicting && position_[v] == kNone) {
+        position_[v] = conflicting_.size();
+        conflicting_.push_back(v);
+      } else if (!conflicting && position_[v] != kNone) {
+        Vertex last = conflicting_.back();
+        conflicting_[position_[v]] = last;
+        position_[last] = position_[v];
+        conflicting_.pop_back();
+        position_[v] = kNone;
+      }
+    }
+
+    GraphView graph_;
+    std::mt19937_64& random_;
+    std::vector<Color> color_;
+    std::vector<std::array<uint32_t, kColors>> gamma_;
+    std::vector<std::array<size_t, kColors>> tabu_;  // iteration until which the color is forbidden
+    std::vector<Vertex> conflicting_;
+    std::vector<size_t> position_;
+    size_t conflicts_ = 0;
+    size_t best_conflicts_ = std::numeric_limits<size_t>::max();
+  };
+
+  // Same peeling as ColoringSolver::drop_2_deg_vertexes_, the core is relabeled to 0..k-1.
+  void make_core_() {
+    std::vector<size_t> degree(graph_.n);
+    std::vector<bool> in_core(graph_.n, true);
+    peeled_.clear();
+    for (Vertex v = 0; v < graph_.n; ++v) {
+      degree[v] = graph_.degree(v);
+      if (degree[v] <= 2) {
+        in_core[v] = false;
+        peeled_.push_back(v);
+      }
+    }
+    for (size_t head = 0; head < peeled_.size(); ++head) {
+      for (auto u: graph_.adjacent(peeled_[head])) {
+        if (in_core[u] && --degree[u] <= 2) {
+          in_core[u] = false;
+          peeled_.push_back(u);
+        }
+      }
+    }
+
+    std::vector<Vertex> index(graph_.n);
+    core_vertexes_.clear();
+    for (Vertex v = 0; v < graph_.n; ++v) {
+      if (in_core[v]) {
+        index[v] = core_vertexes_.size();
+        core_vertexes_.push_back(v);
+      }
+    }
+
+    std::vector<std::pair<Vertex, Vertex>> edges;
+    for (auto v: core_vertexes_) {
+      for (auto u: graph_.adjacent(v)) {
+        if (v < u && in_core[u]) {
+          edges.emplace_back(index[v], index[u]);
+        }
+      }
+    }
+    core_ = Graph::from_sorted_edges(core_vertexes_.size(), edges);
+  }
+
+  void search_(size_t thread) {
+    std::mt19937_64 random(options_.seed + thread);
+    size_t iterations = 0;
+    size_t restarts = 0;
+
+    while (!found_ && Clock::now() < deadline_ &&
+           (options_.max_restarts == 0 || restarts < options_.max_restarts)) {
+      Run run(core_.view(), random);
+      ++restarts;
+
+      for (size_t iteration = 0; run.conflicts() != 0 && iteration < options_.iterations_per_restart;
+           ++iteration, ++iterations) {
+        if (iteration % 1024 == 0 && (found_ || Clock::now() >= deadline_)) {
+          break;
+        }
+        if (!run.step(iteration, options_)) {
+          break;
+        }
+      }
+
+      if (run.conflicts() == 0 && is_valid_(core_.view(), run.colors())) {
+        std::lock_guard lock(mutex_);
+        if (!found_) {
+          result_ = run.colors();
+          found_ = true;
+        }
+      }
+    }
+
+    std::lock_guard lock(mutex_);
+    iterations_ += iterations;
+    restarts_ += restarts;
+  }
+
+  static bool is_valid_(GraphView graph, const std::vector<Color>& colors) {
+    for (Vertex v = 0; v < graph.n; ++v) {
+      for (auto u: graph.adjacent(v)) {
+        if (colors[u] == colors[v]) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  GraphView graph_;
+  TabuOptions options_;
+  Graph core_;
+  std::vector<Vertex> core_vertexes_;
+  std::vector<Vertex> peeled_;
+  Clock::time_point deadline_;
+  std::atomic<bool> found_ = false;
+  std::mutex mutex_;
+  std::vector<Color> result_;
+  size_t iterations_ = 0;
+  size_t restarts_ = 0;
+};
+
+#endif //INC_3COLORING__TABU_HPP_
@@ -0,0 +1,218 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__TRACE_HPP_
+#define INC_3COLORING__TRACE_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct TraceOptions {
+  std::string path = "3coloring.trace.json";
+  size_t max_depth = 64;           // search spans nested deeper than this are not recorded
+  size_t sample_every = 1;         // record one of every N search spans of a thread
+  size_t buffer_events = 1 << 16;  // per thread; the ring keeps the latest events
+
+  // $COLORING_TRACE (path, tracing is off without it), $COLORING_TRACE_DEPTH, $COLORING_TRACE_SAMPLE
+  static std::optional<TraceOptions> from_env() {
+    const char* path = std::getenv("COLORING_TRACE");
+    if (path == nullptr) {
+      return std::nullopt;
+    }
+
+    TraceOptions options;
+    options.path = path;
+    if (const char* depth = std::getenv("COLORING_TRACE_DEPTH")) {
+      options.max_depth = std::stoull(depth);
+    }
+    if (const char* sample = std::getenv("COLORING_TRACE_SAMPLE")) {
+      options.sample_every = std::max<size_t>(std::stoull(sample), 1);
+    }
+    return options;
+  }
+};
+
+// Opt-in recorder of Chrome trace events (complete "X" events), viewable in Perfetto or
+// chrome://tracing. Every thread writes into its own ring buffer without locks; the buffers are
+// collected by write() once the traced work is over. When tracing is off a span costs one atomic
+// load.
+class Trace {
+ public:
+  struct Event {
+    const char* name;
+    const char* category;
+    int64_t begin;     // ns since start()
+    int64_t duration;  // ns
+    uint32_t depth;
+  };
+
+  static bool enabled() {
+    return state_().enabled.load(std::memory_order_acquire);
+  }
+
+  static void start(TraceOptions options) {
+    auto& state = state_();
+    std::lock_guard lock(state.mutex);
+    state.options = std::move(options);
+    state.origin = Clock::now();
+    for (auto& buffer: state.buffers) {
+      buffer->head.store(0, std::memory_order_relaxed);
+    }
+    state.enabled.store(true, std::memory_order_release);
+  }
+
+  // Stops recording and writes the events to options.path.
+  static void stop() {
+    auto& state = state_();
+    state.enabled.store(false, std::memory_order_release);
+
+    std::ofstream file(state.options.path, std::ios::trunc);
+    if (!file) {
+      throw std::runtime_error("Can't create file " + state.options.path);
+    }
+    write(file);
+  }
+
+  static void write(std::ostream& out) {
+    auto& state = state_();
+    std::lock_guard lock(state.mutex);
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    size_t dropped = 0;
+    for (auto& buffer: state.buffers) {
+      size_t head = buffer->head.load(std::memory_order_acquire);
+      size_t size = buffer->events.size();
+      size_t begin = head > size ? head - size : 0;
+      dropped += begin;
+
+      for (size_t i = begin; i < head; ++i) {
+        auto& event = buffer->events[i % size];
+        out << (first ? "\n" : ",\n") << "{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category
+            << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread
+            << ",\"ts\":" << static_cast<double>(event.begin) / 1000.0
+            << ",\"dur\":" << static_cast<double>(event.duration) / 1000.0
+            << ",\"args\":{\"depth\":" << event.depth << "}}";
+        first = false;
+      }
+    }
+    out << "\n],\"otherData\":{\"dropped_events\":" << dropped << "}}\n";
+  }
+
+  static TraceOptions options() {
+    return state_().options;
+  }
+
+ private:
+  friend class TraceSpan;
+  using Clock = std::chrono::steady_clock;
+
+  // single writer: the owning thread; the reader only runs after the traced work
+  struct Buffer {
+    std::vector<Event> events;
+    std::atomic<size_t> head = 0;
+    uint32_t thread = 0;
+    size_t search_spans = 0;  // for sample_every
+    uint32_t depth = 0;       // open search spans
+  };
+
+  struct State {
+    std::atomic<bool> enabled = false;
+    std::mutex mutex;
+    TraceOptions options;
+    Clock::time_point origin = Clock::now();
+    std::vector<std::shared_ptr<Buffer>> buffers;
+  };
+
+  static State& state_() {
+    static State* state = new State();
+    return *state;
+  }
+
+  static Buffer& buffer_() {
+    thread_local std::shared_ptr<Buffer> buffer = [] {
+      auto& state = state_();
+      std::lock_guard lock(state.mutex);
+      auto result = std::make_shared<Buffer>();
+      result->events.resize(std::max<size_t>(state.options.buffer_events, 1));
+      result->thread = static_cast<uint32_t>(state.buffers.size() + 1);
+      state.buffers.push_back(result);
+      return result;
+    }();
+    return *buffer;
+  }
+
+  static int64_t now_() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - state_().origin).count();
+  }
+
+  static void record_(Buffer& buffer, const Event& event) {
+    size_t head = buffer.head.load(std::memory_order_relaxed);
+    buffer.events[head % buffer.events.size()] = event;
+    buffer.head.store(head + 1, std::memory_order_release);
+  }
+};
+
+// Records the time between its construction and destruction. Search spans (SSS rules, seeds) nest
+// into a depth and obey the depth and sampling limits; pipeline spans are always recorded.
+class TraceSpan {
+ public:
+  enum class Kind {
+    kPipeline,
+    kSearch,
+  };
+
+  explicit TraceSpan(const char* name, Kind kind = Kind::kPipeline): name_(name), kind_(kind) {
+    if (!Trace::enabled()) {
+      return;
+    }
+
+    buffer_ = &Trace::buffer_();
+    if (kind_ == Kind::kSearch) {
+      auto& options = Trace::state_().options;
+      depth_ = buffer_->depth++;
+      recorded_ = depth_ < options.max_depth && buffer_->search_spans++ % options.sample_every == 0;
+    } else {
+      recorded_ = true;
+    }
+    if (recorded_) {
+      begin_ = Trace::now_();
+    }
+  }
+
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+  ~TraceSpan() {
+    if (buffer_ == nullptr) {
+      return;
+    }
+    if (kind_ == Kind::kSearch) {
+      --buffer_->depth;
+    }
+    if (recorded_) {
+      Trace::record_(*buffer_, {name_, kind_ == Kind::kSearch ? "search" : "pipeline", begin_,
+                                Trace::now_() - begin_, depth_});
+    }
+  }
+
+ private:
+  const char* name_;
+  Kind kind_;
+  Trace::Buffer* buffer_ = nullptr;
+  bool recorded_ = false;
+  uint32_t depth_ = 0;
+  int64_t begin_ = 0;
+};
+
+#endif //INC_3COLORING__TRACE_HPP_
@@ -0,0 +1,348 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__TREE_DECOMPOSITION_HPP_
+#define INC_3COLORING__TREE_DECOMPOSITION_HPP_
+
+#include "Graph.hpp"
+#include <limits>
+#include <tuple>
+
+// Tree decomposition from an elimination order. Eliminating v turns its remaining neighbours (the
+// separator of v) into a clique; the bag of v is v with its separator, and the parent of the bag is
+// the bag of the separator vertex eliminated first.
+class TreeDecomposition {
+ public:
+  enum class Heuristic {
+    kMinDegree,  // eliminate the vertex with the fewest remaining neighbours
+    kMinFill,    // eliminate the vertex whose elimination adds the fewest edges, ties by degree
+  };
+
+  static constexpr size_t kNone = std::numeric_limits<size_t>::max();
+
+  // Stops as soon as some bag would have more than max_width + 1 vertexes, complete() is false then.
+  explicit TreeDecomposition(GraphView graph, Heuristic heuristic = Heuristic::kMinFill,
+                             size_t max_width = kNone):
+      separators_(graph.n), parents_(graph.n, kNone), children_(graph.n), position_(graph.n, kNone) {
+    eliminate_(graph, heuristic, max_width);
+  }
+
+  bool complete() const {
+    return complete_;
+  }
+  // Max bag size - 1; if the decomposition is incomplete, the width of the bag it stopped at.
+  size_t width() const {
+    return width_;
+  }
+
+  const std::vector<Vertex>& order() const {
+    return order_;
+  }
+  const std::vector<Vertex>& separator(Vertex v) const {
+    return separators_[v];
+  }
+  Vertex parent(Vertex v) const {
+    return parents_[v];
+  }
+  const std::vector<Vertex>& children(Vertex v) const {
+    return children_[v];
+  }
+
+ private:
+  void eliminate_(GraphView graph, Heuristic heuristic, size_t max_width) {
+    std::vector<std::set<Vertex>> adjacent(graph.n);
+    for (Vertex v = 0; v < graph.n; ++v) {
+      for (auto u: graph.adjacent(v)) {
+        if (u != v) {
+          adjacent[v].insert(adjacent[v].end(), u);
+        }
+      }
+    }
+
+    // (fill or degree, degree, vertex); vertexes that can't fit into max_width are scored last
+    using Key = std::tuple<size_t, size_t, Vertex>;
+    auto key = [&](Vertex v) -> Key {
+      auto& around = adjacent[v];
+      if (heuristic == Heuristic::kMinDegree) {
+        return {around.size(), around.size(), v};
+      }
+      if (around.size() > max_width) {
+        return {kNone, around.size(), v};
+      }
+
+      size_t fill = 0;
+      for (auto x = around.begin(); x != around.end(); ++x) {
+        for (auto y = std::next(x); y != around.end(); ++y) {
+          fill += !adjacent[*x].contains(*y);
+        }
+      }
+      return {fill, around.size(), v};
+    };
+
+    std::vector<Key> keys(graph.n);
+    std::set<Key> queue;
+    for (Vertex v = 0; v < graph.n; ++v) {
+      keys[v] = key(v);
+      queue.insert(keys[v]);
+    }
+
+    while (!queue.empty()) {
+      Vertex v = std::get<2>(*queue.begin());
+      queue.erase(queue.begin());
+
+      auto& around = adjacent[v];
+      width_ = std::max(width_, around.size());
+      if (around.size() > max_width) {
+        complete_ = false;
+        return;
+      }
+
+      position_[v] = order_.size();
+      order_.push_back(v);
+      separators_[v].assign(around.begin(), around.end());
+
+      std::set<Vertex> affected(around.begin(), around.end());
+      for (auto x: around) {
+        adjacent[x].erase(v);
+      }
+      for (auto x = around.begin(); x != around.end(); ++x) {
+        for (auto y = std::next(x); y != around.end(); ++y) {
+          if (adjacent[*x].insert(*y).second) {
+            adjacent[*y].insert(*x);
+            if (heuristic == Heuristic::kMinFill) {
+              // the new edge changes the fill of the common neighbours of its ends
+              affected.insert(adjacent[*x].begin(), adjacent[*x].end());
+            }
+          }
+        }
+      }
+      around.clear();
+
+      for (auto u: affected) {
+        if (position_[u] == kNone) {
+          queue.erase(keys[u]);
+          keys[u] = key(u);
+          queue.insert(keys[u]);
+        }
+      }
+    }
+
+    for (auto v: order_) {
+      for (auto u: separators_[v]) {
+        if (parents_[v] == kNone || position_[u] < position_[parents_[v]]) {
+          parents_[v] = u;
+        }
+      }
+      if (parents_[v] != kNone) {
+        children_[parents_[v]].push_back(v);
+      }
+    }
+  }
+
+  std::vector<Vertex> order_;
+  std::vector<std::vector<Vertex>> separators_;
+  std::vector<Vertex> parents_;
+  std::vector<std::vector<Vertex>> children_;
+  std::vector<size_t> position_;
+  size_t width_ = 0;
+  bool complete_ = true;
+};
+
+// Dynamic programming over the bags, children before parents. The table of v maps every coloring of
+// its separator, encoded in base 3, to the number of colorings of v and the vertexes below it; the
+// separator coloring is enumerated as three position bitsets, one per color, so an edge check is
+// one AND. Linear in n and exponential in the width only.
+class TreeDecompositionSolver {
+ public:
+  static constexpr size_t kMaxWidth = 12;  // a table has 3^width entries
+  static constexpr size_t kColors = 3;
+
+  // decomposition must be complete and of width <= kMaxWidth
+  TreeDecompositionSolver(GraphView graph, const TreeDecomposition& decomposition):
+      graph_(graph), decomposition_(decomposition) {
+    if (!decomposition.complete() || decomposition.width() > kMaxWidth) {
+      throw std::runtime_error("Tree decomposition of width " + std::to_string(decomposition.width()) +
+                               " is incomplete or wider than " + std::to_string(kMaxWidth));
+    }
+  }
+
+  // Fills the tables, returns whether the graph is 3-colorable.
+  bool run() {
+    tables_.assign(graph_.n, {});
+    count_ = 1;
+
+    for (Vertex v = 0; v < graph_.n; ++v) {
+      auto adjacent = graph_.adjacent(v);
+      if (std::binary_search(adjacent.begin(), adjacent.end(), v)) {
+        count_ = 0;
+        return false;
+      }
+    }
+
+    for (auto v: decomposition_.order()) {
+      fill_table_(v);
+      if (decomposition_.parent(v) == TreeDecomposition::kNone) {
+        count_ = multiply_(count_, tables_[v][0]);
+      }
+    }
+    return count_ != 0;
+  }
+
+  // Number of 3-colorings, nullopt if it doesn't fit into 64 bits. Needs run().
+  std::optional<uint64_t> count() const {
+    return count_ == kOverflow ? std::nullopt : std::optional<uint64_t>(count_);
+  }
+
+  // A coloring of the whole graph, nullopt if there is none. Needs run().
+  std::optional<Coloring> coloring() const {
+    if (count_ == 0) {
+      return std::nullopt;
+    }
+
+    std::vector<Color> colors(graph_.n, kColors);
+    auto& order = decomposition_.order();
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+      Vertex v = *it;
+      for (Color c = 0; c < kColors; ++c) {
+        colors[v] = c;
+        if (fits_(v, colors)) {
+          break;
+        }
+      }
+    }
+
+    Coloring coloring;
+    for (Vertex v = 0; v < graph_.n; ++v) {
+      coloring.insert(coloring.end(), {v, colors[v]});
+    }
+    return coloring;
+  }
+
+ private:
+  static constexpr uint64_t kOverflow = std::numeric_limits<uint64_t>::max();
+
+  static uint64_t add_(uint64_t x, uint64_t y) {
+    uint64_t result;
+    return __builtin_add_overflow(x, y, &result) ? kOverflow : result;
+  }
+  static uint64_t multiply_(uint64_t x, uint64_t y) {
+    uint64_t result;
+    return __builtin_mul_overflow(x, y, &result) ? kOverflow : result;
+  }
+
+  bool is_adjacent_(Vertex v, Vertex u) const {
+    auto adjacent = graph_.adjacent(v);
+    return std::binary_search(adjacent.begin(), adjacent.end(), u);
+  }
+
+  // index of the separator coloring of v in its table
+  size_t index_(Vertex v, const std::vector<Color>& colors) const {
+    size_t index = 0;
+    auto& separator = decomposition_.separator(v);
+    for (auto it = separator.rbegin(); it != separator.rend(); ++it) {
+      index = index * kColors + colors[*it];
+    }
+    return index;
+  }
+
+  // Is colors[v] free of conflicts with the separator and extendable to every child subtree?
+  bool fits_(Vertex v, const std::vector<Color>& colors) const {
+    for (auto u: decomposition_.separator(v)) {
+      if (colors[u] == colors[v] && is_adjacent_(v, u)) {
+        return false;
+      }
+    }
+    for (auto child: decomposition_.children(v)) {
+      if (tables_[child][index_(child, colors)] == 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void fill_table_(Vertex v) {
+    Deadline::check();
+    auto& separator = decomposition_.separator(v);
+    size_t k = separator.size();
+
+    uint32_t neighbours = 0;
+    for (size_t j = 0; j < k; ++j) {
+      neighbours |= static_cast<uint32_t>(is_adjacent_(v, separator[j])) << j;
+    }
+
+    // Index of the current separator coloring in every child table, kept up to date as the digits
+    // change: digit j of the bag adds digit * weight to the index of each child in updates[j].
+    struct Child {
+      const std::vector<uint64_t>* table;
+      size_t index = 0;
+      size_t own_weight = 0;  // weight of the color of v itself
+    };
+    std::vector<Child> children;
+    std::vector<std::vector<std::pair<size_t, size_t>>> updates(k);
+    for (auto child: decomposition_.children(v)) {
+      Child info{&tables_[child]};
+      size_t weight = 1;
+      for (auto u: decomposition_.separator(child)) {
+        if (u == v) {
+          info.own_weight = weight;
+        } else {
+          size_t j = std::lower_bound(separator.begin(), separator.end(), u) - separator.begin();
+          updates[j].emplace_back(children.size(), weight);
+        }
+        weight *= kColors;
+      }
+      children.push_back(info);
+    }
+
+    size_t size = 1;
+    for (size_t j = 0; j < k; ++j) {
+      size *= kColors;
+    }
+
+    auto& table = tables_[v];
+    table.assign(size, 0);
+    std::vector<Color> digits(k, 0);
+    std::array<uint32_t, kColors> masks = {static_cast<uint32_t>((uint64_t(1) << k) - 1), 0, 0};
+
+    for (size_t index = 0; index < size; ++index) {
+      uint64_t total = 0;
+      for (Color c = 0; c < kColors; ++c) {
+        if ((neighbours & masks[c]) != 0) {
+          continue;
+        }
+
+        uint64_t product = 1;
+        for (auto& child: children) {
+          product = multiply_(product, (*child.table)[child.index + c * child.own_weight]);
+          if (product == 0) {
+            break;
+          }
+        }
+        total = add_(total, product);
+      }
+      table[index] = total;
+
+      // next separator coloring, digit j is the color of separator[j]
+      for (size_t j = 0; j < k; ++j) {
+        masks[digits[j]] &= ~(uint32_t(1) << j);
+        Color next = (digits[j] + 1) % kColors;
+        for (auto [child, weight]: updates[j]) {
+          children[child].index = children[child].index + next * weight - digits[j] * weight;
+        }
+        digits[j] = next;
+        masks[next] |= uint32_t(1) << j;
+        if (next != 0) {
+          break;
+        }
+      }
+    }
+  }
+
+  GraphView graph_;
+  const TreeDecomposition& decomposition_;
+  std::vector<std::vector<uint64_t>> tables_;
+  uint64_t count_ = 0;
+};
+
+#endif //INC_3COLORING__TREE_DECOMPOSITION_HPP_
@@ -0,0 +1,158 @@
+//
+// Created by aleks311001 on 19.10.2026.
+//
+
+#ifndef INC_3COLORING__VERTEX_ORDER_HPP_
+#define INC_3COLORING__VERTEX_ORDER_HPP_
+
+#include "Graph.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Renumberings that put adjacent vertexes at nearby ids, so the neighbour sets of Edges and the
+// (vertex, color) pairs of SSS, both ordered by id, keep a vertex and its neighbours in nearby
+// nodes and cache lines.
+enum class VertexOrder {
+  kInput,
+  kBfs,                  // breadth-first from the lowest id of each component
+  kReverseCuthillMcKee,  // BFS from a minimum degree vertex, neighbours by degree, reversed
+  kDegeneracy,           // minimum degree peeling, reversed: the densest core gets the lowest ids
+};
+
+inline const char* vertex_order_name(VertexOrder order) {
+  switch (order) {
+    case VertexOrder::kInput:
+      return "input";
+    case VertexOrder::kBfs:
+      return "bfs";
+    case VertexOrder::kReverseCuthillMcKee:
+      return "rcm";
+    case VertexOrder::kDegeneracy:
+      return "degeneracy";
+  }
+  return "";
+}
+
+inline VertexOrder parse_vertex_order(const std::string& name) {
+  for (auto order: {VertexOrder::kInput, VertexOrder::kBfs, VertexOrder::kReverseCuthillMcKee,
+                    VertexOrder::kDegeneracy}) {
+    if (name == vertex_order_name(order)) {
+      return order;
+    }
+  }
+  throw std::runtime_error("Unknown vertex order " + name);
+}
+
+// labels[i] is the vertex that gets id i.
+inline std::vector<Vertex> vertex_order(GraphView graph, VertexOrder order) {
+  std::vector<Vertex> labels;
+  labels.reserve(graph.n);
+
+  if (order == VertexOrder::kInput) {
+    for (Vertex v = 0; v < graph.n; ++v) {
+      labels.push_back(v);
+    }
+    return labels;
+  }
+
+  if (order == VertexOrder::kDegeneracy) {
+    // bucket queue by current degree
+    std::vector<size_t> degree(graph.n);
+    std::vector<std::vector<Vertex>> buckets;
+    std::vector<bool> removed(graph.n, false);
+    for (Vertex v = 0; v < graph.n; ++v) {
+      degree[v] = graph.degree(v);
+      if (degree[v] >= buckets.size()) {
+        buckets.resize(degree[v] + 1);
+      }
+      buckets[degree[v]].push_back(v);
+    }
+
+    size_t low = 0;
+    while (labels.size() < graph.n) {
+      while (buckets[low].empty()) {
+        ++low;
+      }
+      Vertex v = buckets[low].back();
+      buckets[low].pop_back();
+      if (removed[v] || degree[v] != low) {
+        continue;  // stale entry
+      }
+
+      removed[v] = true;
+      labels.push_back(v);
+      for (auto u: graph.adjacent(v)) {
+        if (!removed[u] && degree[u] > 0) {
+          buckets[--degree[u]].push_back(u);
+          low = std::min(low, degree[u]);
+        }
+      }
+    }
+    std::reverse(labels.begin(), labels.end());
+    return labels;
+  }
+
+  bool rcm = order == VertexOrder::kReverseCuthillMcKee;
+  std::vector<Vertex> starts(graph.n);
+  for (Vertex v = 0; v < graph.n; ++v) {
+    starts[v] = v;
+  }
+  if (rcm) {
+    std::stable_sort(starts.begin(), starts.end(), [&](Vertex v, Vertex u) {
+      return graph.degree(v) < graph.degree(u);
+    });
+  }
+
+  std::vector<bool> visited(graph.n, false);
+  std::vector<Vertex> next;
+  for (auto start: starts) {
+    if (visited[start]) {
+      continue;
+    }
+    visited[start] = true;
+    labels.push_back(start);
+    for (size_t head = labels.size() - 1; head < labels.size(); ++head) {
+      next.clear();
+      for (auto u: graph.adjacent(labels[head])) {
+        if (!visited[u]) {
+          visited[u] = true;
+          next.push_back(u);
+        }
+      }
+      if (rcm) {
+        std::stable_sort(next.begin(), next.end(), [&](Vertex v, Vertex u) {
+          return graph.degree(v) < graph.degree(u);
+        });
+      }
+      labels.insert(labels.end(), next.begin(), next.end());
+    }
+  }
+  if (rcm) {
+    std::reverse(labels.begin(), labels.end());
+  }
+  return labels;
+}
+
+// The graph with vertex labels[i] renamed to i.
+inline Graph relabel_graph(GraphView graph, const std::vector<Vertex>& labels) {
+  std::vector<Vertex> ids(graph.n);
+  for (Vertex i = 0; i < labels.size(); ++i) {
+    ids[labels[i]] = i;
+  }
+
+  std::vector<std::pair<Vertex, Vertex>> edges;
+  edges.reserve(graph.num_arcs() / 2 + 1);
+  for (Vertex v = 0; v < graph.n; ++v) {
+    for (auto u: graph.adjacent(v)) {
+      if (v <= u) {
+        edges.emplace_back(std::min(ids[v], ids[u]), std::max(ids[v], ids[u]));
+      }
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+  return Graph::from_sorted_edges(graph.n, edges);
+}
+
+#endif //INC_3COLORING__VERTEX_ORDER_HPP_
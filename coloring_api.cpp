@@ -0,0 +1,46 @@
+#include "ColoringApi.hpp"
+#include "Coloring.hpp"
+#include "Selector.hpp"
+
+// The engine comes from the default cost model: the profile file is machine state, not input. No
+// component cache either, an answer never depends on the graphs solved before.
+ColoringStatus solve_3coloring(ColoringGraph graph, std::span<size_t> colors) noexcept {
+  try {
+    GraphView view{graph.n, graph.offsets, graph.neighbours};
+    if (!view.is_valid()) {
+      return ColoringStatus::kInvalidGraph;
+    }
+    if (colors.size() < graph.n) {
+      return ColoringStatus::kOutputTooSmall;
+    }
+
+    ColoringSolver solver(view);
+    solver.set_cache(nullptr);
+    if (!run_engine(solver, CostModel::defaults().choose(solver.features()))) {
+      return ColoringStatus::kNotColorable;
+    }
+
+    for (auto [v, color]: solver.coloring_) {
+      colors[v] = color;
+    }
+    return ColoringStatus::kColorable;
+  } catch (...) {
+    return ColoringStatus::kError;
+  }
+}
+
+const char* coloring_status_name(ColoringStatus status) noexcept {
+  switch (status) {
+    case ColoringStatus::kColorable:
+      return "colorable";
+    case ColoringStatus::kNotColorable:
+      return "not colorable";
+    case ColoringStatus::kInvalidGraph:
+      return "invalid graph";
+    case ColoringStatus::kOutputTooSmall:
+      return "output too small";
+    case ColoringStatus::kError:
+      return "error";
+  }
+  return "unknown";
+}
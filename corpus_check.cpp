@@ -0,0 +1,305 @@
+#include "Coloring.hpp"
+#include "ColoringApi.hpp"
+#include "Selector.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+
+// Runs every engine over data/graphN.g6 and data/graphNc.g6, compares the answers with
+// stupid_solve() and checks every returned coloring.
+// Usage: corpus_check [data directory] [max n]
+
+struct EngineRun {
+  std::string name;
+  bool complete;  // false: may answer "unknown" (nullopt) on colorable graphs
+  std::function<std::optional<Coloring>(const std::string& line, bool& answer)> run;
+  bool cached = false;  // runs with the component cache, the others run without it
+};
+
+struct EngineStats {
+  size_t graphs = 0;
+  size_t colorable = 0;
+  size_t unknown = 0;
+  size_t mismatches = 0;
+  size_t invalid = 0;
+  double seconds = 0;
+};
+
+bool is_valid_coloring(const Graph& graph, const Coloring& coloring) {
+  GraphView view = graph.view();
+  for (Vertex v = 0; v < view.n; ++v) {
+    auto it = coloring.find(v);
+    if (it == coloring.end() || it->second >= 3) {
+      return false;
+    }
+    for (auto u: view.adjacent(v)) {
+      auto other = coloring.find(u);
+      if (other != coloring.end() && other->second == it->second) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Same solver as main.cpp builds from stdin: vertexes and edges one by one.
+ColoringSolver edges_solver(const Graph& graph) {
+  GraphView view = graph.view();
+  ColoringSolver solver;
+  solver.create_vertexes(view.n);
+  solver.add_all_colors();
+  for (Vertex v = 0; v < view.n; ++v) {
+    for (auto u: view.adjacent(v)) {
+      if (v < u) {
+        solver.add_edge(v, u);
+      }
+    }
+  }
+  return solver;
+}
+
+using Build = ColoringSolver (*)(const Graph&);
+
+ColoringSolver graph_solver(const Graph& graph) {
+  return ColoringSolver(graph);
+}
+
+template<class Solve>
+EngineRun exact_engine(const std::string& name, Build build, Solve solve) {
+  return {name, true, [build, solve](const std::string& line, bool& answer) -> std::optional<Coloring> {
+    ColoringSolver solver = build(read_graph6(line));
+    answer = solve(solver);
+    return answer ? std::optional<Coloring>(solver.coloring_) : std::nullopt;
+  }};
+}
+
+NogoodStats nogood_totals;
+
+std::vector<EngineRun> engines() {
+  return {
+      exact_engine("solve", graph_solver, [](ColoringSolver& solver) {
+        return solver.solve();
+      }),
+      exact_engine("solve-edges", edges_solver, [](ColoringSolver& solver) {
+        return solver.solve();
+      }),
+      // the second solve answers from the entries of the first, the witnesses must still hold
+      {"solve-cache", true, [](const std::string& line, bool& answer) -> std::optional<Coloring> {
+        Graph graph = read_graph6(line);
+        bool first = ColoringSolver(graph).solve();
+        ColoringSolver solver(graph);
+        answer = solver.solve();
+        if (answer != first) {
+          answer = true;
+          return std::nullopt;  // reported as an invalid coloring
+        }
+        return answer ? std::optional<Coloring>(solver.coloring_) : std::nullopt;
+      }, true},
+      exact_engine("stupid", edges_solver, [](ColoringSolver& solver) {
+        return solver.stupid_solve();
+      }),
+      // runs without the component cache like the rest, so every repeated subproblem is left to the
+      // nogoods; main() fails the run if they prune nothing
+      exact_engine("solve-nogoods", graph_solver, [](ColoringSolver& solver) {
+        solver.set_nogoods({});
+        bool answer = solver.solve();
+        nogood_totals += solver.nogood_stats();
+        return answer;
+      }),
+      // the coloring of SSS<3, 2> itself, not completed by the solver: every vertex must be in it
+      {"sss-witness", true, [](const std::string& line, bool& answer) -> std::optional<Coloring> {
+        Graph graph = read_graph6(line);
+        GraphView view = graph.view();
+        SSS<3, 2> sss;
+        sss.set_vertexes(view.n);
+        sss.add_all_colors();
+        for (Vertex v = 0; v < view.n; ++v) {
+          for (auto u: view.adjacent(v)) {
+            for (Color color = 0; color < 3 && v < u; ++color) {
+              sss.add_constraint({{v, color}, {u, color}});
+            }
+          }
+        }
+        answer = sss.solve();
+        return answer ? std::optional<Coloring>(sss.coloring) : std::nullopt;
+      }},
+      // SSS<4, 2> with the lists {0, 1, 2}: one trial, its witness comes from SSS<3, 2>
+      {"list-coloring", true, [](const std::string& line, bool& answer) -> std::optional<Coloring> {
+        Graph graph = read_graph6(line);
+        std::map<Vertex, std::set<Color>> lists;
+        for (Vertex v = 0; v < graph.n; ++v) {
+          lists[v] = {0, 1, 2};
+        }
+        ColoringSolver solver(graph);
+        answer = solver.solve_list_coloring(lists);
+        return answer ? std::optional<Coloring>(solver.coloring_) : std::nullopt;
+      }},
+      exact_engine("solve-rcm", graph_solver, [](ColoringSolver& solver) {
+        solver.reorder(VertexOrder::kReverseCuthillMcKee);
+        return solver.solve();
+      }),
+      exact_engine("stupid-degeneracy", edges_solver, [](ColoringSolver& solver) {
+        solver.reorder(VertexOrder::kDegeneracy);
+        return solver.stupid_solve();
+      }),
+      exact_engine("treewidth-bfs", edges_solver, [](ColoringSolver& solver) {
+        solver.reorder(VertexOrder::kBfs);
+        return solver.solve_tree_decomposition();
+      }),
+      exact_engine("treewidth", graph_solver, [](ColoringSolver& solver) {
+        return solver.solve_tree_decomposition();
+      }),
+      exact_engine("treewidth-edges", edges_solver, [](ColoringSolver& solver) {
+        return solver.solve_tree_decomposition();
+      }),
+      // every enumerated coloring must be valid and their number must match the DP count
+      {"enumerate", true, [](const std::string& line, bool& answer) -> std::optional<Coloring> {
+        Graph graph = read_graph6(line);
+        ColoringSolver solver(graph);
+        std::optional<Coloring> first;
+        uint64_t count = 0;
+        for (auto& coloring: solver.colorings()) {
+          if (!is_valid_coloring(graph, coloring)) {
+            first.reset();
+            break;
+          }
+          if (count++ == 0) {
+            first = coloring;
+          }
+        }
+        answer = count != 0;
+        return count == solver.count_colorings() ? first : std::nullopt;
+      }},
+      {"library", true, [](const std::string& line, bool& answer) -> std::optional<Coloring> {
+        Graph graph = read_graph6(line);
+        std::vector<size_t> colors(graph.n);
+        auto status = solve_3coloring({graph.n, graph.offsets, graph.neighbours}, colors);
+        answer = status == ColoringStatus::kColorable;
+        if (!answer) {
+          return std::nullopt;
+        }
+        Coloring coloring;
+        for (Vertex v = 0; v < graph.n; ++v) {
+          coloring[v] = colors[v];
+        }
+        return coloring;
+      }},
+      exact_engine("auto", graph_solver, [](ColoringSolver& solver) {
+        return run_engine(solver, CostModel::defaults().choose(solver.features()));
+      }),
+      {"tabu", false, [](const std::string& line, bool& answer) {
+        TabuOptions options;
+        options.iterations_per_restart = 1000;
+        options.max_restarts = 2;
+        auto coloring = ColoringSolver(read_graph6(line)).tabu_solve(options);
+        answer = coloring.has_value();
+        return coloring;
+      }},
+  };
+}
+
+int main(int argc, char* argv[]) {
+  std::filesystem::path data = argc > 1 ? argv[1] : "data";
+  size_t max_n = argc > 2 ? std::stoull(argv[2]) : 8;
+
+  // solve-cache runs with $COLORING_CACHE* and a cache emptied for every file, the other engines
+  // without one, so that no engine answers from the entries of another
+  auto cache_options = ComponentCacheOptions::from_env();
+  ComponentCacheOptions no_cache;
+  no_cache.max_vertexes = 0;
+  auto runs = engines();
+  std::vector<EngineStats> total(runs.size());
+  bool failed = false;
+  size_t largest = 0;  // n of the largest graphs read
+
+  for (size_t n = 1; n <= max_n; ++n) {
+    for (std::string suffix: {"", "c"}) {
+      auto path = data / ("graph" + std::to_string(n) + suffix + ".g6");
+      std::ifstream file(path);
+      if (!file) {
+        continue;
+      }
+
+      largest = n;
+      std::vector<std::string> lines;
+      for (std::string line; std::getline(file, line);) {
+        if (!line.empty()) {
+          lines.push_back(line);
+        }
+      }
+
+      std::vector<bool> expected;
+      for (auto& line: lines) {
+        expected.push_back(edges_solver(read_graph6(line)).stupid_solve());
+      }
+
+      for (size_t e = 0; e < runs.size(); ++e) {
+        ComponentCache::global().configure(runs[e].cached ? cache_options : no_cache);
+        EngineStats stats;
+        for (size_t i = 0; i < lines.size(); ++i) {
+          bool answer = false;
+          auto begin = std::chrono::steady_clock::now();
+          auto coloring = runs[e].run(lines[i], answer);
+          stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+          ++stats.graphs;
+          stats.colorable += answer;
+          bool mismatch = runs[e].complete ? answer != expected[i] : answer && !expected[i];
+          stats.unknown += !runs[e].complete && !answer && expected[i];
+          bool invalid = answer && (!coloring || !is_valid_coloring(read_graph6(lines[i]), *coloring));
+
+          if (mismatch || invalid) {
+            if (stats.mismatches + stats.invalid < 3) {
+              std::cerr << path.filename().string() << " " << lines[i] << ": " << runs[e].name << " answered "
+                        << answer << ", expected " << expected[i] << (invalid ? ", invalid coloring" : "") << "\n";
+            }
+            stats.mismatches += mismatch;
+            stats.invalid += invalid;
+          }
+        }
+
+        std::cout << path.filename().string() << " " << runs[e].name << ": graphs=" << stats.graphs
+                  << " colorable=" << stats.colorable << " unknown=" << stats.unknown
+                  << " mismatches=" << stats.mismatches << " invalid=" << stats.invalid
+                  << " graphs/s=" << static_cast<double>(stats.graphs) / stats.seconds << "\n";
+
+        failed |= stats.mismatches != 0 || stats.invalid != 0;
+        total[e].graphs += stats.graphs;
+        total[e].colorable += stats.colorable;
+        total[e].unknown += stats.unknown;
+        total[e].mismatches += stats.mismatches;
+        total[e].invalid += stats.invalid;
+        total[e].seconds += stats.seconds;
+      }
+    }
+  }
+
+  for (size_t e = 0; e < runs.size(); ++e) {
+    std::cout << "total " << runs[e].name << ": graphs=" << total[e].graphs
+              << " colorable=" << total[e].colorable << " unknown=" << total[e].unknown
+              << " mismatches=" << total[e].mismatches << " invalid=" << total[e].invalid
+              << " graphs/s=" << static_cast<double>(total[e].graphs) / total[e].seconds << "\n";
+  }
+
+  auto pool = NodePool::stats();
+  std::cout << "pool: allocations=" << pool.allocations << " deallocations=" << pool.deallocations
+            << " peak bytes=" << pool.peak_bytes << " chunk bytes=" << pool.chunk_bytes << "\n";
+  auto cache = ComponentCache::global().stats();
+  std::cout << "component cache: hits=" << cache.hits << " misses=" << cache.misses
+            << " entries=" << cache.entries << " evictions=" << cache.evictions
+            << " rejected=" << cache.rejected << "\n";
+  auto fast = FastPaths::stats();
+  std::cout << "fast paths: bipartite=" << fast.bipartite << " max_degree_3=" << fast.max_degree_3
+            << " chordal=" << fast.chordal << "\n";
+  std::cout << "nogoods: learned=" << nogood_totals.learned << " pruned=" << nogood_totals.pruned
+            << " deleted=" << nogood_totals.deleted << " checks=" << nogood_totals.checks << "\n";
+  // graph8 is the smallest corpus on which the nogoods prune
+  if (largest >= 8 && nogood_totals.pruned == 0) {
+    std::cerr << "solve-nogoods pruned nothing on graphs of up to " << largest << " vertexes\n";
+    failed = true;
+  }
+
+  return failed ? 1 : 0;
+}
@@ -1,6 +1,10 @@
 #include <iostream>
 #include "SSS.hpp"
 #include "Coloring.hpp"
+#include "GraphIO.hpp"
+#include "Selector.hpp"
+#include "Daemon.hpp"
+#include "CubeAndConquer.hpp"
 #include <fstream>
 #include <chrono>
 
@@ -61,7 +65,7 @@ void test_Coloring() {
   }
 }
 
-std::pair<ColoringSolver, bool> parse(std::istream& file) {
+std::pair<ColoringSolver, std::string> parse(std::istream& file) {
   ColoringSolver solver;
 
   size_t n, m = 0;
@@ -79,26 +83,305 @@ std::pair<ColoringSolver, bool> parse(std::istream& file) {
   std::string str;
   file >> str;
 
-  return {solver, str == "fast"};
+  return {solver, str};
 }
 
-int main(/*int argc, char* argv[]*/) {
-//  if (argc == 1) {
-//    std::cerr << "Input filename";
-//    return 1;
-//  }
-//
-//  std::ifstream file(argv[1]);
-  auto [solver, fast] = parse(std::cin);
+bool is_binary_graph(const std::string& path) {
+  char magic[sizeof(BinaryGraphHeader::kMagic)] = {};
+  std::ifstream file(path, std::ios::binary);
+  file.read(magic, sizeof(magic));
+  return file && std::equal(magic, magic + sizeof(magic), BinaryGraphHeader::kMagic);
+}
+
+std::pair<ColoringSolver, std::string> parse_file(const std::string& path) {
+  if (is_binary_graph(path)) {
+    return {ColoringSolver(MappedGraph::open(path)), "fast"};
+  }
+
+  auto [graph, mode] = EdgeListParser().parse_file(path);
+  return {ColoringSolver(std::move(graph)), mode};
+}
+
+// convert <input> <output> [line]: text edge list or graph6 (line-th graph of the file) to binary
+int convert(int argc, char* argv[]) {
+  if (argc < 4) {
+    std::cerr << "Usage: " << argv[0] << " convert <input> <output> [graph6 line]" << std::endl;
+    return 1;
+  }
+
+  std::string input = argv[2];
+  Graph graph;
+  if (input.ends_with(".g6")) {
+    size_t index = argc > 4 ? std::stoull(argv[4]) : 0;
+    std::ifstream file(input);
+    std::string line;
+    for (size_t i = 0; i <= index; ++i) {
+      if (!std::getline(file, line)) {
+        std::cerr << "File " << input << " has no graph " << index << std::endl;
+        return 1;
+      }
+    }
+    graph = read_graph6(line);
+  } else {
+    graph = EdgeListParser().parse_file(input).graph;
+  }
+
+  BinaryGraphWriter::write(argv[3], graph.view());
+  return 0;
+}
+
+// calibrate [profile] [max n]: times the engines on this machine and stores the cost model
+int calibrate(int argc, char* argv[]) {
+  std::string path = argc > 2 ? argv[2] : CostModel::default_path();
+  Calibrator::Options options;
+  if (argc > 3) {
+    options.max_n = std::stoull(argv[3]);
+  }
+
+  auto model = Calibrator(options).run(&std::cerr);
+  model.save(path);
+  std::cout << "Profile saved to " << path << std::endl;
+  return 0;
+}
+
+// daemon <socket> [workers] [queue limit]: serves solve requests until daemon-stop
+int run_daemon(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " daemon <socket> [workers] [queue limit]" << std::endl;
+    return 1;
+  }
+
+  SolverDaemon::Options options;
+  options.socket_path = argv[2];
+  if (argc > 3) {
+    options.workers = std::stoull(argv[3]);
+  }
+  if (argc > 4) {
+    options.queue_limit = std::stoull(argv[4]);
+  }
+  ComponentCache::global().configure(ComponentCacheOptions::from_env());
+  SolverDaemon(options).serve();
+  ComponentCache::global().save();
+  return 0;
+}
+
+// request <socket> <graph> [deadline ms]: solves the graph file on a running daemon
+int send_request(int argc, char* argv[]) {
+  if (argc < 4) {
+    std::cerr << "Usage: " << argv[0] << " request <socket> <graph> [deadline ms]" << std::endl;
+    return 1;
+  }
+
+  std::string path = argv[3];
+  std::shared_ptr<const MappedGraph> mapped;
+  Graph graph;
+  GraphView view;
+  if (is_binary_graph(path)) {
+    mapped = MappedGraph::open(path);
+    view = mapped->view();
+  } else {
+    graph = EdgeListParser().parse_file(path).graph;
+    view = graph.view();
+  }
+
+  std::chrono::milliseconds deadline(argc > 4 ? std::stoull(argv[4]) : 0);
+  auto result = DaemonClient(argv[2]).solve(view, deadline);
+  std::cout << daemon_protocol::status_name(result.status) << std::endl;
+  for (Vertex v = 0; v < result.colors.size(); ++v) {
+    std::cout << v << ": " << result.colors[v] << "\n";
+  }
+  return result.status == daemon_protocol::Status::kColorable ||
+         result.status == daemon_protocol::Status::kNotColorable ? 0 : 2;
+}
+
+Graph read_graph_file(const std::string& path) {
+  if (is_binary_graph(path)) {
+    auto mapped = MappedGraph::open(path);
+    GraphView view = mapped->view();
+    return {view.n, {view.offsets.begin(), view.offsets.end()}, {view.neighbours.begin(), view.neighbours.end()}};
+  }
+  return EdgeListParser().parse_file(path).graph;
+}
+
+// split <graph> <depth> <directory>: writes the cube-and-conquer work units of the graph
+int run_split(int argc, char* argv[]) {
+  if (argc < 5) {
+    std::cerr << "Usage: " << argv[0] << " split <graph> <depth> <directory>" << std::endl;
+    return 1;
+  }
+
+  Graph graph = read_graph_file(argv[2]);
+  size_t units = split_work(graph.view(), std::stoull(argv[3]), argv[4]);
+  std::cout << units << " work units" << std::endl;
+  return 0;
+}
+
+// conquer <unit> <result>: solves one work unit, exits with 10 if colorable and 20 if not
+int run_conquer(int argc, char* argv[]) {
+  if (argc < 4) {
+    std::cerr << "Usage: " << argv[0] << " conquer <unit> <result>" << std::endl;
+    return 1;
+  }
+
+  auto coloring = conquer(WorkUnit::load(argv[2]));
+  Coordinator::write_result(argv[3], coloring);
+  return coloring ? Coordinator::kColorable : Coordinator::kNotColorable;
+}
+
+// coordinate <directory> [workers]: conquers all units of the directory in worker processes
+int run_coordinate(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " coordinate <directory> [workers]" << std::endl;
+    return 1;
+  }
+
+  size_t workers = argc > 3 ? std::stoull(argv[3]) : std::thread::hardware_concurrency();
+  auto coloring = Coordinator(std::filesystem::read_symlink("/proc/self/exe"), argv[2], workers).run();
+  std::cout << (coloring ? 1 : 0) << std::endl;
+  if (coloring) {
+    for (auto& item: *coloring) {
+      std::cout << item.first << ": " << item.second << "\n";
+    }
+  }
+  return 0;
+}
+
+// in auto mode, graphs this large try local search before the exact engines
+constexpr size_t kTabuFirstVertexes = 5000;
+
+int main(int argc, char* argv[]) {
+  if (argc > 1 && std::string(argv[1]) == "convert") {
+    return convert(argc, argv);
+  }
+  if (argc > 1 && std::string(argv[1]) == "calibrate") {
+    return calibrate(argc, argv);
+  }
+  if (argc > 1 && std::string(argv[1]) == "daemon") {
+    return run_daemon(argc, argv);
+  }
+  if (argc > 1 && std::string(argv[1]) == "request") {
+    return send_request(argc, argv);
+  }
+  if (argc > 1 && std::string(argv[1]) == "split") {
+    return run_split(argc, argv);
+  }
+  if (argc > 1 && std::string(argv[1]) == "conquer") {
+    return run_conquer(argc, argv);
+  }
+  if (argc > 1 && std::string(argv[1]) == "coordinate") {
+    return run_coordinate(argc, argv);
+  }
+  if (argc > 2 && std::string(argv[1]) == "daemon-stats") {
+    std::cout << DaemonClient(argv[2]).stats() << std::endl;
+    return 0;
+  }
+  if (argc > 2 && std::string(argv[1]) == "daemon-stop") {
+    DaemonClient(argv[2]).shutdown();
+    return 0;
+  }
+
+  // COLORING_TRACE=<file> writes a Chrome trace of the run
+  auto trace = TraceOptions::from_env();
+  if (trace) {
+    Trace::start(*trace);
+  }
+
+  // COLORING_CACHE=<file> keeps the component cache between runs
+  ComponentCache::global().configure(ComponentCacheOptions::from_env());
+
+  auto [solver, mode] = argc > 1 ? parse_file(argv[1]) : parse(std::cin);
+  if (argc > 2) {
+    mode = argv[2];
+  }
+  // third argument: input, bfs, rcm or degeneracy renumbering before solving
+  if (argc > 3) {
+    solver.reorder(parse_vertex_order(argv[3]));
+  }
+  // COLORING_CHECKPOINT=<file> saves the progress of the exact search and resumes from it, down to
+  // a seed tree leaf: the SSS<3, 2> search of the leaf that was running starts over on resume
+  if (auto checkpoint = CheckpointOptions::from_env()) {
+    solver.set_checkpoint(*checkpoint);
+  }
+
+  // COLORING_NOGOODS=<capacity> learns nogoods from the failed leaves of the exact search
+  auto nogoods = NogoodOptions::from_env();
+  if (nogoods) {
+    solver.set_nogoods(*nogoods);
+  }
+
+  // COLORING_PROGRESS=<seconds> reports the progress of the exact search to stderr
+  SearchProgress progress;
+  std::optional<ProgressScope> progress_scope;
+  std::optional<ProgressReporter> reporter;
+  if (auto options = ProgressOptions::from_env()) {
+    progress_scope.emplace(progress);
+    reporter.emplace(progress, options->interval, [](const ProgressSnapshot& snapshot) {
+      snapshot.write_json(std::cerr);
+      std::cerr << std::endl;
+    });
+  }
 
   auto begin = std::chrono::high_resolution_clock::now();
-  if (fast) {
+  if (mode == "auto") {
+    auto features = solver.features();
+    if (features.n >= kTabuFirstVertexes) {
+      solver.set_tabu({});
+    }
+    auto engine = CostModel::load().choose(features);
+    std::cerr << "Engine: " << engine_name(engine) << std::endl;
+    mode = engine_name(engine);
+  }
+
+  if (mode == "tabu") {
+    auto coloring = solver.tabu_solve();
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin);
+
+    std::cout << (coloring ? "1" : "unknown") << std::endl;
+    std::cout << duration.count() << std::endl;
+    if (coloring) {
+      for (auto& item: *coloring) {
+        std::cout << item.first << ": " << item.second << "\n";
+      }
+    }
+  } else if (mode == "count") {
+    auto count = solver.count_colorings();
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin);
+
+    if (count) {
+      std::cout << *count << std::endl;
+    } else {
+      std::cout << "overflow" << std::endl;
+    }
+    std::cout << duration.count() << std::endl;
+  } else if (mode == "treewidth") {
+    bool ans = solver.solve_tree_decomposition();
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin);
+
+    std::cout << ans << std::endl;
+    std::cout << duration.count() << std::endl;
+    for (auto& item: solver.coloring_) {
+      std::cout << item.first << ": " << item.second << "\n";
+    }
+  } else if (mode == "fast") {
     bool ans = solver.solve();
     auto end = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin);
 
     std::cout << ans << std::endl;
     std::cout << duration.count() << std::endl;
+  } else if (mode == "four") {
+    bool ans = solver.solve_list_coloring();
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin);
+
+    std::cout << ans << std::endl;
+    std::cout << duration.count() << std::endl;
+    for (auto& item: solver.coloring_) {
+      std::cout << item.first << ": " << item.second << "\n";
+    }
   } else {
     bool ans = solver.stupid_solve();
     auto end = std::chrono::high_resolution_clock::now();
@@ -111,5 +394,21 @@ int main(/*int argc, char* argv[]*/) {
     }
   }
 
+  reporter.reset();
+  auto fast = FastPaths::stats();
+  if (fast.bipartite + fast.max_degree_3 + fast.chordal != 0) {
+    std::cerr << "Fast paths: bipartite=" << fast.bipartite << " max_degree_3=" << fast.max_degree_3
+              << " chordal=" << fast.chordal << std::endl;
+  }
+  if (nogoods) {
+    auto stats = solver.nogood_stats();
+    std::cerr << "Nogoods: learned=" << stats.learned << " pruned=" << stats.pruned << " deleted=" << stats.deleted
+              << " checks=" << stats.checks << " entries=" << stats.entries << std::endl;
+  }
+  if (trace) {
+    Trace::stop();
+  }
+  ComponentCache::global().save();
+
   return 0;
 }
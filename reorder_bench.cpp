@@ -0,0 +1,153 @@
+#include "Coloring.hpp"
+#include "GraphIO.hpp"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Cache behaviour of solve() under each VertexOrder: time, cache references and misses, L1d read
+// misses, from the hardware counters of this thread (perf_event_open; "n/a" where the kernel or
+// the VM doesn't expose them).
+// Usage: reorder_bench [repeats] [graph file...]; without files it generates planted 3-colorable
+// graphs with shuffled vertex ids, like the ones our pipelines produce.
+
+class Counter {
+ public:
+  Counter(uint32_t type, uint64_t config) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+  Counter(const Counter&) = delete;
+  Counter& operator=(const Counter&) = delete;
+  ~Counter() {
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+  }
+
+  void start() {
+    if (fd_ >= 0) {
+      ::ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+      ::ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+  std::optional<uint64_t> stop() {
+    uint64_t value = 0;
+    if (fd_ < 0) {
+      return std::nullopt;
+    }
+    ::ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+    if (::read(fd_, &value, sizeof(value)) != sizeof(value)) {
+      return std::nullopt;
+    }
+    return value;
+  }
+
+ private:
+  int fd_ = -1;
+};
+
+constexpr uint64_t kL1dReadMisses = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                    (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+Graph planted_graph(size_t n, double degree, std::mt19937_64& random) {
+  std::vector<Color> colors(n);
+  std::vector<Vertex> ids(n);
+  for (Vertex v = 0; v < n; ++v) {
+    colors[v] = v % 3;
+    ids[v] = v;
+  }
+  std::shuffle(ids.begin(), ids.end(), random);
+
+  std::bernoulli_distribution edge(degree / static_cast<double>(n - 1) * 1.5);
+  std::vector<std::pair<Vertex, Vertex>> edges;
+  for (Vertex v = 0; v < n; ++v) {
+    for (Vertex u = v + 1; u < n; ++u) {
+      if (colors[v] != colors[u] && edge(random)) {
+        edges.emplace_back(std::min(ids[v], ids[u]), std::max(ids[v], ids[u]));
+      }
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+  return Graph::from_sorted_edges(n, edges);
+}
+
+// per solve
+std::string show(std::optional<uint64_t> total, size_t repeats) {
+  return total ? std::to_string(*total / repeats) : "n/a";
+}
+
+int main(int argc, char* argv[]) {
+  size_t repeats = std::max<size_t>(argc > 1 ? std::stoull(argv[1]) : 5, 1);
+
+  std::vector<std::pair<std::string, Graph>> graphs;
+  for (int i = 2; i < argc; ++i) {
+    graphs.emplace_back(argv[i], EdgeListParser().parse_file(argv[i]).graph);
+  }
+  if (graphs.empty()) {
+    std::mt19937_64 random(1);
+    for (auto [n, degree]: {std::pair{100, 4.0}, std::pair{150, 4.0}, std::pair{3000, 2.5}}) {
+      graphs.emplace_back("planted n=" + std::to_string(n) + " degree=" + std::to_string(degree).substr(0, 3),
+                          planted_graph(n, degree, random));
+    }
+  }
+
+  // repeats must not be answered from the cache
+  ComponentCacheOptions cache;
+  cache.max_vertexes = 0;
+  ComponentCache::global().configure(cache);
+
+  Counter references(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES);
+  Counter misses(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+  Counter l1d(PERF_TYPE_HW_CACHE, kL1dReadMisses);
+
+  for (auto& [name, graph]: graphs) {
+    for (auto order: {VertexOrder::kInput, VertexOrder::kBfs, VertexOrder::kReverseCuthillMcKee,
+                      VertexOrder::kDegeneracy}) {
+      double seconds = 0;
+      std::optional<uint64_t> total_references = 0, total_misses = 0, total_l1d = 0;
+      bool answer = false;
+
+      for (size_t r = 0; r < repeats; ++r) {
+        ColoringSolver solver(graph);
+        solver.reorder(order);
+
+        auto begin = std::chrono::steady_clock::now();
+        references.start();
+        misses.start();
+        l1d.start();
+        answer = solver.solve();
+        auto l1d_count = l1d.stop();
+        auto miss_count = misses.stop();
+        auto reference_count = references.stop();
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        for (auto [total, count]: {std::pair{&total_references, reference_count},
+                                   std::pair{&total_misses, miss_count}, std::pair{&total_l1d, l1d_count}}) {
+          *total = *total && count ? std::optional(**total + *count) : std::nullopt;
+        }
+      }
+
+      std::cout << name << " " << vertex_order_name(order) << ": answer=" << answer
+                << " ms=" << seconds * 1000 / static_cast<double>(repeats)
+                << " cache_references=" << show(total_references, repeats)
+                << " cache_misses=" << show(total_misses, repeats) << " l1d_read_misses=" << show(total_l1d, repeats);
+      if (total_references && total_misses && *total_references != 0) {
+        std::cout << " miss_rate=" << static_cast<double>(*total_misses) / static_cast<double>(*total_references);
+      }
+      std::cout << std::endl;
+    }
+  }
+  return 0;
+}